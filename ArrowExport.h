@@ -0,0 +1,396 @@
+#pragma once
+
+#include "StarSystem.h"
+#include "RegionExport.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * The Arrow column types the exporter writes, none of them nullable
+ */
+enum class ArrowType {
+    UInt8, UInt32, Float64, Bool
+};
+
+struct ArrowField {
+    std::string_view name;
+    ArrowType type;
+};
+
+/**
+ * Builds a flatbuffer front to back, which is all Arrow's metadata needs: every table is written before
+ * what it points to, so offsets, which must point forward, are filled in once their targets exist
+ */
+class FlatBuilder {
+public:
+    std::vector<uint8_t> bytes = std::vector<uint8_t>(4); // Starts with the offset to the root table
+
+    struct Table {
+        size_t start = 0;
+        size_t field[8]{};
+    };
+
+    /**
+     * Adds a table with its vtable in front, sizes[i] is the size of field i or 0 if it is left out.
+     * Fields are laid out largest first so each is aligned
+     */
+    Table table(std::initializer_list<uint8_t> sizes) {
+        uint16_t offsets[8]{};
+        uint16_t inlineSize = 4;
+        for (uint8_t size: {8, 4, 2, 1}) {
+            size_t i = 0;
+            for (uint8_t fieldSize: sizes) {
+                if (fieldSize == size) {
+                    inlineSize = uint16_t((inlineSize + size - 1) / size * size);
+                    offsets[i] = inlineSize;
+                    inlineSize += size;
+                }
+                i++;
+            }
+        }
+
+        align(2);
+        const size_t vtable = bytes.size();
+        append<uint16_t>(uint16_t(4 + 2 * sizes.size()));
+        append<uint16_t>(inlineSize);
+        for (size_t i = 0; i < sizes.size(); i++) append<uint16_t>(offsets[i]);
+
+        align(8);
+        Table table;
+        table.start = bytes.size();
+        bytes.resize(table.start + inlineSize);
+        put<int32_t>(table.start, int32_t(table.start - vtable));
+        for (size_t i = 0; i < sizes.size(); i++) table.field[i] = offsets[i] ? table.start + offsets[i] : 0;
+        return table;
+    }
+
+    /**
+     * Adds a vector of count elements, zeroed, returns where its length is, the elements follow it
+     */
+    size_t vector(size_t count, size_t elementSize, size_t elementAlign = 4) {
+        align(4);
+        while ((bytes.size() + 4) % elementAlign) bytes.push_back(0);
+        const size_t start = bytes.size();
+        append<uint32_t>(uint32_t(count));
+        bytes.resize(bytes.size() + count * elementSize);
+        return start;
+    }
+
+    size_t string(std::string_view text) {
+        align(4);
+        const size_t start = bytes.size();
+        append<uint32_t>(uint32_t(text.size()));
+        bytes.insert(bytes.end(), text.begin(), text.end());
+        bytes.push_back(0);
+        return start;
+    }
+
+    template<typename T>
+    void put(size_t at, T value) { std::memcpy(&bytes[at], &value, sizeof(T)); }
+
+    // Points the offset at `at` to target, which must come after it
+    void link(size_t at, size_t target) { put<uint32_t>(at, uint32_t(target - at)); }
+
+    void align(size_t alignment) {
+        while (bytes.size() % alignment) bytes.push_back(0);
+    }
+
+private:
+    template<typename T>
+    void append(T value) {
+        bytes.resize(bytes.size() + sizeof(T));
+        put(bytes.size() - sizeof(T), value);
+    }
+};
+
+/**
+ * Rows of one table, column by column in Arrow's layout, ready to be written as a record batch
+ */
+class ArrowBatch {
+public:
+    explicit ArrowBatch(const std::vector<ArrowField> &fields) : fields(&fields), columns(fields.size()) {}
+
+    template<typename T>
+    void append(size_t column, T value) {
+        auto &data = columns[column];
+        data.resize(data.size() + sizeof(T));
+        std::memcpy(&data[data.size() - sizeof(T)], &value, sizeof(T));
+    }
+
+    // Booleans are one bit each, the row being filled decides which
+    void appendBool(size_t column, bool value) {
+        auto &data = columns[column];
+        if (rows % 8 == 0) data.push_back(0);
+        if (value) data.back() |= uint8_t(1u << (rows % 8));
+    }
+
+    void endRow() { rows++; }
+
+    void clear() {
+        rows = 0;
+        for (auto &column: columns) column.clear();
+    }
+
+    const std::vector<ArrowField> *fields;
+    std::vector<std::vector<uint8_t>> columns;
+    uint64_t rows = 0;
+};
+
+/**
+ * Writes one table as an Arrow IPC file, also known as Feather version 2, a record batch at a time
+ */
+class ArrowFileWriter {
+public:
+    ArrowFileWriter(const std::string &path, const std::vector<ArrowField> &fields)
+            : file(path, std::ios::binary), fields(fields) {
+        file.write("ARROW1\0\0", 8);
+        FlatBuilder message;
+        const size_t header = startMessage(message, 1, 0);
+        message.link(header, writeSchema(message));
+        writeMessage(message);
+    }
+
+    bool good() const { return file.good(); }
+
+    void write(const ArrowBatch &batch) {
+        // Each column is a validity buffer, empty since nothing is null, then its values padded to 8 bytes
+        uint64_t bodyLength = 0;
+        for (const auto &column: batch.columns) bodyLength += padded(column.size());
+
+        FlatBuilder message;
+        const size_t header = startMessage(message, 3, bodyLength);
+        const FlatBuilder::Table recordBatch = message.table({8, 4, 4});
+        message.link(header, recordBatch.start);
+        message.put<int64_t>(recordBatch.field[0], int64_t(batch.rows));
+
+        const size_t nodes = message.vector(batch.columns.size(), 16, 8);
+        message.link(recordBatch.field[1], nodes);
+        for (size_t c = 0; c < batch.columns.size(); c++) {
+            message.put<int64_t>(nodes + 4 + c * 16, int64_t(batch.rows));
+            message.put<int64_t>(nodes + 4 + c * 16 + 8, 0);
+        }
+
+        const size_t buffers = message.vector(batch.columns.size() * 2, 16, 8);
+        message.link(recordBatch.field[2], buffers);
+        uint64_t offset = 0;
+        for (size_t c = 0; c < batch.columns.size(); c++) {
+            const size_t entry = buffers + 4 + c * 32;
+            message.put<int64_t>(entry, int64_t(offset));
+            message.put<int64_t>(entry + 8, 0);
+            message.put<int64_t>(entry + 16, int64_t(offset));
+            message.put<int64_t>(entry + 24, int64_t(batch.columns[c].size()));
+            offset += padded(batch.columns[c].size());
+        }
+
+        const Block block = {uint64_t(file.tellp()), writeMessage(message), bodyLength};
+        static const char zeros[8] = {};
+        for (const auto &column: batch.columns) {
+            file.write((const char *) column.data(), std::streamsize(column.size()));
+            file.write(zeros, std::streamsize(padded(column.size()) - column.size()));
+        }
+        blocks.push_back(block);
+    }
+
+    /**
+     * Ends the stream and writes the footer, which lets readers seek straight to any batch
+     */
+    bool close() {
+        const uint32_t endOfStream[2] = {0xFFFFFFFF, 0};
+        file.write((const char *) endOfStream, sizeof(endOfStream));
+
+        FlatBuilder footer;
+        const FlatBuilder::Table table = footer.table({2, 4, 4, 4});
+        footer.link(0, table.start);
+        footer.put<int16_t>(table.field[0], METADATA_V5);
+        footer.link(table.field[1], writeSchema(footer));
+        footer.link(table.field[2], footer.vector(0, 24, 8));
+        const size_t batches = footer.vector(blocks.size(), 24, 8);
+        footer.link(table.field[3], batches);
+        for (size_t b = 0; b < blocks.size(); b++) {
+            footer.put<int64_t>(batches + 4 + b * 24, int64_t(blocks[b].offset));
+            footer.put<int32_t>(batches + 4 + b * 24 + 8, int32_t(blocks[b].metadataLength));
+            footer.put<int64_t>(batches + 4 + b * 24 + 16, int64_t(blocks[b].bodyLength));
+        }
+
+        const uint32_t footerLength = uint32_t(footer.bytes.size());
+        file.write((const char *) footer.bytes.data(), std::streamsize(footer.bytes.size()));
+        file.write((const char *) &footerLength, sizeof(footerLength));
+        file.write("ARROW1", 6);
+        file.close();
+        return !file.fail();
+    }
+
+private:
+    static const int16_t METADATA_V5 = 4;
+
+    struct Block {
+        uint64_t offset;
+        uint32_t metadataLength;
+        uint64_t bodyLength;
+    };
+
+    static uint64_t padded(uint64_t size) { return (size + 7) & ~uint64_t(7); }
+
+    /**
+     * Adds the root Message table, returns where the offset to its header goes
+     */
+    static size_t startMessage(FlatBuilder &message, uint8_t headerType, uint64_t bodyLength) {
+        const FlatBuilder::Table table = message.table({2, 1, 4, 8});
+        message.link(0, table.start);
+        message.put<int16_t>(table.field[0], METADATA_V5);
+        message.put<uint8_t>(table.field[1], headerType);
+        message.put<int64_t>(table.field[3], int64_t(bodyLength));
+        return table.field[2];
+    }
+
+    size_t writeSchema(FlatBuilder &builder) const {
+        const FlatBuilder::Table schema = builder.table({2, 4});
+        const size_t fieldList = builder.vector(fields.size(), 4);
+        builder.link(schema.field[1], fieldList);
+
+        for (size_t f = 0; f < fields.size(); f++) {
+            // name, nullable, type_type, type, dictionary, children
+            const FlatBuilder::Table field = builder.table({4, 1, 1, 4, 0, 4});
+            builder.link(fieldList + 4 + f * 4, field.start);
+            builder.link(field.field[0], builder.string(fields[f].name));
+
+            FlatBuilder::Table type;
+            switch (fields[f].type) {
+                case ArrowType::UInt8:
+                case ArrowType::UInt32:
+                    builder.put<uint8_t>(field.field[2], 2);
+                    type = builder.table({4, 1});
+                    builder.put<int32_t>(type.field[0], fields[f].type == ArrowType::UInt8 ? 8 : 32);
+                    break;
+                case ArrowType::Float64:
+                    builder.put<uint8_t>(field.field[2], 3);
+                    type = builder.table({2});
+                    builder.put<int16_t>(type.field[0], 2);
+                    break;
+                case ArrowType::Bool:
+                    builder.put<uint8_t>(field.field[2], 6);
+                    type = builder.table({});
+                    break;
+            }
+            builder.link(field.field[3], type.start);
+            builder.link(field.field[5], builder.vector(0, 4));
+        }
+        return schema.start;
+    }
+
+    /**
+     * Writes the metadata with its continuation marker and length, padded so the body that follows is
+     * aligned, returns how many bytes that took
+     */
+    uint32_t writeMessage(FlatBuilder &message) {
+        message.align(8);
+        const uint32_t prefix[2] = {0xFFFFFFFF, uint32_t(message.bytes.size())};
+        file.write((const char *) prefix, sizeof(prefix));
+        file.write((const char *) message.bytes.data(), std::streamsize(message.bytes.size()));
+        return uint32_t(sizeof(prefix) + message.bytes.size());
+    }
+
+    std::ofstream file;
+    const std::vector<ArrowField> &fields;
+    std::vector<Block> blocks;
+};
+
+// One row per star, then one per planet, keyed by sector so the two can be joined
+const std::vector<ArrowField> arrowSystemFields = {
+        {"sector_x", ArrowType::UInt32}, {"sector_y", ArrowType::UInt32}, {"star_diameter", ArrowType::Float64},
+        {"star_color", ArrowType::UInt32}, {"planets", ArrowType::UInt8}
+};
+
+const std::vector<ArrowField> arrowPlanetFields = {
+        {"sector_x", ArrowType::UInt32}, {"sector_y", ArrowType::UInt32}, {"planet", ArrowType::UInt8},
+        {"color", ArrowType::UInt32}, {"distance", ArrowType::Float64}, {"diameter", ArrowType::Float64},
+        {"temperature", ArrowType::Float64}, {"population", ArrowType::Float64}, {"flora", ArrowType::Bool},
+        {"water", ArrowType::Bool}, {"ring", ArrowType::Bool}, {"minerals", ArrowType::UInt8},
+        {"gasses", ArrowType::UInt8}, {"moons", ArrowType::UInt8}
+};
+
+/**
+ * Catalog entries as a bitmask, bit i standing for catalog[i]
+ */
+template<size_t N>
+inline uint8_t catalogMask(const CatalogPicks &picks, const std::array<std::string_view, N> &catalog) {
+    uint8_t mask = 0;
+    for (const auto &name: picks)
+        mask |= uint8_t(1u << (std::find(catalog.begin(), catalog.end(), name) - catalog.begin()));
+    return mask;
+}
+
+/**
+ * A band of rows of the region, as one record batch of systems and one of planets
+ */
+struct ArrowChunk {
+    ArrowBatch systems{arrowSystemFields};
+    ArrowBatch planets{arrowPlanetFields};
+};
+
+inline void generateArrowChunk(const ExportRegion &region, uint64_t band, ArrowChunk &chunk) {
+    chunk.systems.clear();
+    chunk.planets.clear();
+    const uint32_t rowEnd = uint32_t(std::min<uint64_t>(region.height, (band + 1) * region.bandRows));
+    for (uint32_t row = uint32_t(band * region.bandRows); row < rowEnd; row++)
+        for (uint32_t column = 0; column < region.width; column++) {
+            const uint32_t x = region.originX + column, y = region.originY + row;
+            const StarSystem star(x, y, true);
+            if (!star.starExists) continue;
+
+            ArrowBatch &systems = chunk.systems;
+            systems.append<uint32_t>(0, x);
+            systems.append<uint32_t>(1, y);
+            systems.append<double>(2, star.starDiameter);
+            systems.append<uint32_t>(3, exportColor(star.starColor));
+            systems.append<uint8_t>(4, uint8_t(star.planets.size()));
+            systems.endRow();
+
+            ArrowBatch &planets = chunk.planets;
+            for (size_t i = 0; i < star.planets.size(); i++) {
+                const Planet &planet = star.planets[i];
+                planets.append<uint32_t>(0, x);
+                planets.append<uint32_t>(1, y);
+                planets.append<uint8_t>(2, uint8_t(i));
+                planets.append<uint32_t>(3, exportColor(planet.color));
+                planets.append<double>(4, planet.distance);
+                planets.append<double>(5, planet.diameter);
+                planets.append<double>(6, planet.temperature);
+                planets.append<double>(7, planet.population);
+                planets.appendBool(8, planet.flora);
+                planets.appendBool(9, planet.water);
+                planets.appendBool(10, planet.ring);
+                planets.append<uint8_t>(11, catalogMask(planet.minerals, MINERALS));
+                planets.append<uint8_t>(12, catalogMask(planet.gasses, GASSES));
+                planets.append<uint8_t>(13, uint8_t(planet.moons.size()));
+                planets.endRow();
+            }
+        }
+}
+
+/**
+ * Exports the region's systems to systemsPath and their planets to planetsPath, a record batch per band.
+ * Bands are generated on threads and written in order, with a few per thread in memory at a time
+ */
+inline bool exportArrow(const ExportRegion &region, unsigned threads, const std::string &systemsPath,
+                        const std::string &planetsPath) {
+    ArrowFileWriter systems(systemsPath, arrowSystemFields), planets(planetsPath, arrowPlanetFields);
+    if (!systems.good() || !planets.good()) return false;
+
+    produceInOrder<ArrowChunk>(
+            region.bands(), threads, size_t(threads) * 2,
+            [&](uint64_t band, ArrowChunk &chunk) { generateArrowChunk(region, band, chunk); },
+            [&](ArrowChunk &chunk) {
+                systems.write(chunk.systems);
+                planets.write(chunk.planets);
+            });
+    const bool systemsClosed = systems.close();
+    return planets.close() && systemsClosed;
+}
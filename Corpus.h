@@ -0,0 +1,220 @@
+#pragma once
+
+#include "StarSystem.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * Every generated value the corpus checks, hashed separately so a mismatch names what changed
+ */
+enum CorpusField {
+    STAR_EXISTS, STAR_DIAMETER, STAR_COLOR, PLANET_COUNT,
+    PLANET_COLOR, PLANET_DISTANCE, PLANET_DIAMETER, PLANET_FLORA, PLANET_MINERALS, PLANET_WATER,
+    PLANET_GASSES, PLANET_TEMPERATURE, PLANET_POPULATION, PLANET_RING, PLANET_MOONS,
+    CORPUS_FIELD_COUNT
+};
+
+constexpr const char *corpusFieldNames[CORPUS_FIELD_COUNT] = {
+        "star.exists", "star.diameter", "star.color", "planet.count",
+        "planet.color", "planet.distance", "planet.diameter", "planet.flora", "planet.minerals", "planet.water",
+        "planet.gasses", "planet.temperature", "planet.population", "planet.ring", "planet.moons"
+};
+
+/**
+ * 64-bit FNV-1a, fed value by value in generation order
+ */
+struct RollingHash {
+    uint64_t value = 0xcbf29ce484222325ull;
+
+    void add(const void *data, size_t size) {
+        auto bytes = (const uint8_t *) data;
+        for (size_t i = 0; i < size; i++) {
+            value ^= bytes[i];
+            value *= 0x100000001b3ull;
+        }
+    }
+
+    // Doubles are hashed by bit pattern, so even a last-bit rounding change shows up
+    void add(double v) { add(&v, sizeof(v)); }
+
+    void add(uint32_t v) { add(&v, sizeof(v)); }
+
+    void add(bool v) { add(uint32_t(v)); }
+
+    // Names are hashed as text, the terminator keeps "Iron", "Zinc" apart from "IronZ", "inc"
+    void add(std::string_view s) {
+        add(s.data(), s.size());
+        add("", 1);
+    }
+};
+
+using CorpusHashes = std::array<uint64_t, CORPUS_FIELD_COUNT>;
+
+/**
+ * A square block of sectors, generated as full systems, with rows split into bands
+ */
+struct CorpusRegion {
+    uint32_t originX = 0;
+    uint32_t originY = 0;
+    uint32_t size = 4096;
+    uint32_t bandRows = 64;
+
+    uint32_t bands() const { return (size + bandRows - 1) / bandRows; }
+
+    bool operator==(const CorpusRegion &other) const {
+        return originX == other.originX && originY == other.originY && size == other.size &&
+               bandRows == other.bandRows;
+    }
+};
+
+/**
+ * Field hashes over a whole region, plus one combined hash per band of rows to narrow down where a change is
+ */
+struct CorpusDigest {
+    CorpusRegion region;
+    CorpusHashes fields{};
+    std::vector<uint64_t> bands;
+};
+
+inline void hashStarSystem(const StarSystem &star, std::array<RollingHash, CORPUS_FIELD_COUNT> &hashes) {
+    hashes[STAR_EXISTS].add(star.starExists);
+    if (!star.starExists) return;
+
+    hashes[STAR_DIAMETER].add(star.starDiameter);
+    hashes[STAR_COLOR].add(star.starColor.n);
+    hashes[PLANET_COUNT].add(uint32_t(star.planets.size()));
+
+    for (const auto &planet: star.planets) {
+        hashes[PLANET_COLOR].add(planet.color.n);
+        hashes[PLANET_DISTANCE].add(planet.distance);
+        hashes[PLANET_DIAMETER].add(planet.diameter);
+        hashes[PLANET_FLORA].add(planet.flora);
+        hashes[PLANET_MINERALS].add(uint32_t(planet.minerals.size()));
+        for (const auto &mineral: planet.minerals) hashes[PLANET_MINERALS].add(mineral);
+        hashes[PLANET_WATER].add(planet.water);
+        hashes[PLANET_GASSES].add(uint32_t(planet.gasses.size()));
+        for (const auto &gas: planet.gasses) hashes[PLANET_GASSES].add(gas);
+        hashes[PLANET_TEMPERATURE].add(planet.temperature);
+        hashes[PLANET_POPULATION].add(planet.population);
+        hashes[PLANET_RING].add(planet.ring);
+        hashes[PLANET_MOONS].add(uint32_t(planet.moons.size()));
+        for (double moon: planet.moons) hashes[PLANET_MOONS].add(moon);
+    }
+}
+
+/**
+ * Generates every system in the region, bands are shared out between threads and folded back in order
+ */
+inline CorpusDigest generateCorpus(const CorpusRegion &region, unsigned threads) {
+    const uint32_t bandCount = region.bands();
+    std::vector<CorpusHashes> bandFields(bandCount);
+
+    auto hashBand = [&](uint32_t band) {
+        std::array<RollingHash, CORPUS_FIELD_COUNT> hashes;
+        const uint32_t rowEnd = std::min(region.size, (band + 1) * region.bandRows);
+        for (uint32_t y = band * region.bandRows; y < rowEnd; y++)
+            for (uint32_t x = 0; x < region.size; x++)
+                hashStarSystem(StarSystem(region.originX + x, region.originY + y, true), hashes);
+        for (int f = 0; f < CORPUS_FIELD_COUNT; f++) bandFields[band][f] = hashes[f].value;
+    };
+
+    threads = std::max(1u, std::min(threads, bandCount));
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++)
+        workers.emplace_back([&, t]() {
+            for (uint32_t band = t; band < bandCount; band += threads) hashBand(band);
+        });
+    for (auto &worker: workers) worker.join();
+
+    CorpusDigest digest;
+    digest.region = region;
+    std::array<RollingHash, CORPUS_FIELD_COUNT> fields;
+    for (const auto &band: bandFields) {
+        RollingHash combined;
+        for (int f = 0; f < CORPUS_FIELD_COUNT; f++) {
+            fields[f].add(&band[f], sizeof(band[f]));
+            combined.add(&band[f], sizeof(band[f]));
+        }
+        digest.bands.push_back(combined.value);
+    }
+    for (int f = 0; f < CORPUS_FIELD_COUNT; f++) digest.fields[f] = fields[f].value;
+    return digest;
+}
+
+inline bool saveCorpusDigest(const CorpusDigest &digest, const std::string &path) {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+
+    file << "# Generator corpus, rewrite with: ProceduralUniverseTool corpus record\n";
+    file << "region " << digest.region.originX << " " << digest.region.originY << " " << digest.region.size << " "
+         << digest.region.bandRows << "\n";
+    file << std::hex << std::setfill('0');
+    for (int f = 0; f < CORPUS_FIELD_COUNT; f++)
+        file << "field " << corpusFieldNames[f] << " " << std::setw(16) << digest.fields[f] << "\n";
+    for (size_t b = 0; b < digest.bands.size(); b++)
+        file << "band " << std::dec << b << " " << std::hex << std::setw(16) << digest.bands[b] << "\n";
+    return file.good();
+}
+
+inline bool loadCorpusDigest(CorpusDigest &digest, const std::string &path) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    digest = CorpusDigest();
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream stream(line);
+        std::string kind;
+        if (!(stream >> kind) || kind[0] == '#') continue;
+
+        if (kind == "region") {
+            stream >> digest.region.originX >> digest.region.originY >> digest.region.size >> digest.region.bandRows;
+        } else if (kind == "field") {
+            std::string name;
+            uint64_t value;
+            stream >> name >> std::hex >> value;
+            auto found = std::find(std::begin(corpusFieldNames), std::end(corpusFieldNames), name);
+            if (found == std::end(corpusFieldNames)) return false;
+            digest.fields[found - std::begin(corpusFieldNames)] = value;
+        } else if (kind == "band") {
+            size_t band;
+            uint64_t value;
+            stream >> band >> std::hex >> value;
+            if (band != digest.bands.size()) return false;
+            digest.bands.push_back(value);
+        } else
+            return false;
+
+        if (stream.fail()) return false;
+    }
+    return digest.region.bandRows > 0 && digest.bands.size() == digest.region.bands();
+}
+
+/**
+ * Reports each field and band of rows that differs, returns how many fields differ
+ */
+inline int compareCorpus(const CorpusDigest &expected, const CorpusDigest &actual, std::ostream &out) {
+    int fieldsDiffering = 0;
+    for (int f = 0; f < CORPUS_FIELD_COUNT; f++) {
+        if (expected.fields[f] == actual.fields[f]) continue;
+        fieldsDiffering++;
+        out << "  field " << corpusFieldNames[f] << " differs\n";
+    }
+
+    for (size_t b = 0; b < expected.bands.size() && b < actual.bands.size(); b++) {
+        if (expected.bands[b] == actual.bands[b]) continue;
+        const uint32_t rowStart = expected.region.originY + uint32_t(b) * expected.region.bandRows;
+        out << "  rows " << rowStart << " to " << rowStart + expected.region.bandRows - 1 << " differ\n";
+    }
+    return fieldsDiffering;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * Text built up in a fixed buffer, for HUD lines and exports that are formatted every frame. Nothing is
+ * allocated, text past the capacity is cut off. Numbers come out as an ostream with default settings
+ * writes them, doubles with 6 significant digits
+ */
+template<size_t N>
+class FixedText {
+public:
+    FixedText &operator<<(std::string_view text) {
+        const size_t count = std::min(text.size(), N - length);
+        for (size_t i = 0; i < count; i++) buffer[length + i] = text[i];
+        length += count;
+        return *this;
+    }
+
+    // Without this, literals would go to a bool overload before string_view
+    FixedText &operator<<(const char *text) { return *this << std::string_view(text); }
+
+    FixedText &operator<<(char c) {
+        if (length < N) buffer[length++] = c;
+        return *this;
+    }
+
+    FixedText &operator<<(double value) {
+        const auto result = std::to_chars(buffer + length, buffer + N, value, std::chars_format::general, 6);
+        if (result.ec == std::errc()) length = size_t(result.ptr - buffer);
+        return *this;
+    }
+
+    template<typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                                          !std::is_same_v<T, char>, int> = 0>
+    FixedText &operator<<(T value) {
+        const auto result = std::to_chars(buffer + length, buffer + N, value);
+        if (result.ec == std::errc()) length = size_t(result.ptr - buffer);
+        return *this;
+    }
+
+    std::string_view view() const { return {buffer, length}; }
+
+    size_t size() const { return length; }
+
+    void clear() { length = 0; }
+
+private:
+    char buffer[N];
+    size_t length = 0;
+};
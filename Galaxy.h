@@ -0,0 +1,519 @@
+#pragma once
+
+#include "olcPixelGameEngine.h"
+#include "StarSystem.h"
+#include "SectorCache.h"
+#include "PlanetTexture.h"
+#include "Orbits.h"
+#include "FixedText.h"
+#include "TileStore.h"
+
+#include <memory>
+
+/**
+ * A galaxy containing many star systems
+ */
+class Galaxy : public olc::PixelGameEngine {
+    static const int SECTOR_SIZE = 16;
+
+    static const int PLANETS_WINDOW_X = 8;
+    static const int PLANETS_WINDOW_Y = 240;
+    static const int PLANETS_WINDOW_W = 496;
+    static const int PLANETS_WINDOW_H = 232;
+
+public:
+    Galaxy() {
+        sAppName = "Galaxy View";
+        // Panning runs in fixed ticks, so how far the camera gets, and which sectors it
+        // generates on the way, does not depend on the frame rate
+        SetFixedTimestep(1.0f / 60.0f);
+    }
+
+    // Camera position as of the last tick, the view is interpolated from the one before
+    olc::vf2d galaxyOffset = {0, 0};
+    bool starSelected{false};
+    olc::vi2d selectedStarPosition{0, 0};
+    bool showFrameStats{false};
+    // Sectors generated ahead of the camera on a background thread, 0 turns prefetching off
+    int prefetchDistance{8};
+    bool prefetchFull{false};
+    // Selected systems are generated on a background thread, the window shows a placeholder meanwhile
+    bool asyncSystems{true};
+    // Planet surfaces and other generated images, least recently used ones go first once over budget
+    olc::SpriteCache spriteCache{16 * 1024 * 1024};
+    // O shows the selected system's planets and moons going round, P the planets of every visible system
+    bool orbitView{false};
+    bool orbitsEverywhere{false};
+    // Stars follow a spiral galaxy's bulge, arms and voids rather than a flat 1 in 20 chance per sector
+    bool shapedGalaxy{false};
+
+    /**
+     * Reads stars from a tile store rather than generating them, wherever the view is inside it. Call
+     * before Construct, after shapedGalaxy is set. False if the file cannot be read or was built for the
+     * other galaxy shape
+     */
+    bool openTileStore(const std::string &path) {
+        tileStore = std::make_unique<tiles::TileStore>();
+        if (tileStore->open(path) && tileStore->getHeader().shaped == shapedGalaxy) return true;
+        tileStore.reset();
+        return false;
+    }
+
+    bool OnUserCreate() override {
+        // Stars get a layer of their own beneath layer 0, which keeps the hover ring and planet window
+        starLayer = (uint8_t) CreateLayer();
+        EnableLayer(starLayer, true);
+        previousOffset = viewOffset = galaxyOffset;
+        if (shapedGalaxy) {
+            galaxyShape = std::make_unique<GalaxyShape>();
+            sectorCache.setShape(galaxyShape.get());
+        }
+        if (prefetchDistance > 0)
+            prefetcher = std::make_unique<SectorPrefetcher>(sectorCache, prefetchDistance, prefetchFull);
+        if (asyncSystems) systemLoader = std::make_unique<SystemLoader>(sectorCache);
+        if (tileStore) tilePager = std::make_unique<tiles::TilePager>(*tileStore);
+        return true;
+    }
+
+    bool OnFixedUpdate(float fStep) override {
+        previousOffset = galaxyOffset;
+        if (GetKey(olc::W).bHeld) galaxyOffset.y -= 50.0f * fStep;
+        if (GetKey(olc::S).bHeld) galaxyOffset.y += 50.0f * fStep;
+        if (GetKey(olc::A).bHeld) galaxyOffset.x -= 50.0f * fStep;
+        if (GetKey(olc::D).bHeld) galaxyOffset.x += 50.0f * fStep;
+        velocity = fStep > 0.0f ? (galaxyOffset - previousOffset) / fStep : olc::vf2d{0, 0};
+        previousOrbitTime = orbitTime;
+        orbitTime += fStep;
+        return true;
+    }
+
+    bool OnUserUpdate(float) override {
+        spriteCache.NextFrame();
+        viewOffset = previousOffset + (galaxyOffset - previousOffset) * GetFixedAlpha();
+        if (GetKey(olc::F1).bPressed) ShowFrameStats(showFrameStats = !showFrameStats);
+        if (GetKey(olc::O).bPressed) orbitView = !orbitView;
+        if (GetKey(olc::P).bPressed) orbitsEverywhere = !orbitsEverywhere;
+        orbitRenderTime = previousOrbitTime + (orbitTime - previousOrbitTime) * GetFixedAlpha();
+
+        // Keep frames coming while panning, even if no new input arrives, and after until the camera
+        // settles where the last tick left it
+        if (GetKey(olc::W).bHeld || GetKey(olc::S).bHeld || GetKey(olc::A).bHeld || GetKey(olc::D).bHeld ||
+            previousOffset != galaxyOffset)
+            RequestFrame();
+
+        int nSectorX = ScreenWidth() / SECTOR_SIZE;
+        int nSectorY = ScreenHeight() / SECTOR_SIZE;
+
+        if (prefetcher)
+            prefetcher->update({(uint32_t) viewOffset.x, (uint32_t) viewOffset.y, (uint32_t) nSectorX,
+                                (uint32_t) nSectorY}, velocity);
+
+        olc::vi2d mouse = {GetMouseX() / SECTOR_SIZE, GetMouseY() / 16};
+        olc::vi2d galaxyMouse = mouse + viewOffset;
+
+        // If the planet is selected, draw the planets
+        if (GetMouse(0).bPressed) {
+            StarSystem star(galaxyMouse.x, galaxyMouse.y, false,
+                            sectorCache.starProbability(galaxyMouse.x, galaxyMouse.y));
+
+            if (star.starExists) {
+                starSelected = true;
+                selectedStarPosition = galaxyMouse;
+                selectSystem(galaxyMouse);
+            } else {
+                starSelected = false;
+                selectedSystem.reset();
+                pendingSystem.reset();
+            }
+        }
+
+        // Pick up the selected system once the loader has it, polling every frame until then
+        if (pendingSystem) {
+            if (pendingSystem->ready()) {
+                selectedSystem = pendingSystem->get();
+                pendingSystem.reset();
+            } else
+                RequestFrame();
+        }
+
+        // Only layers whose content changed are redrawn, and so uploaded. If neither did,
+        // the last frame stays on screen
+        ViewState view{(uint32_t) viewOffset.x, (uint32_t) viewOffset.y, mouse, starSelected,
+                       selectedStarPosition, selectedSystem != nullptr, heldPlanetKeys(), orbitView,
+                       orbitsEverywhere};
+        // Orbits move every frame, so whichever layer shows them is always redrawn, as are stars until
+        // their tiles have been read
+        const bool animateSystem = orbitView && selectedSystem;
+        if (animateSystem || orbitsEverywhere || tilesPending) RequestFrame();
+        const bool starsChanged = !hasDrawn || view.offsetX != lastView.offsetX || view.offsetY != lastView.offsetY ||
+                                  view.orbitsEverywhere != lastView.orbitsEverywhere || orbitsEverywhere ||
+                                  tilesPending;
+        const bool overlayChanged = !hasDrawn || !(view == lastView) || animateSystem;
+        if (!overlayChanged && !starsChanged && !showFrameStats) {
+            SkipFrame();
+            return true;
+        }
+        lastView = view;
+        hasDrawn = true;
+
+        if (starsChanged) drawStars(nSectorX, nSectorY);
+        if (overlayChanged) drawOverlay(mouse, nSectorX, nSectorY);
+
+        return true;
+    }
+
+    /**
+     * Draws the star in each on-screen sector onto the star layer
+     */
+    void drawStars(int nSectorX, int nSectorY) {
+        OLC_ALLOC_SCOPE("stars");
+        OLC_PROFILE_ZONE("stars");
+        SetDrawTarget(starLayer);
+        Clear(olc::BLACK);
+
+        getVisibleSectors({(uint32_t) viewOffset.x, (uint32_t) viewOffset.y, (uint32_t) nSectorX,
+                           (uint32_t) nSectorY});
+
+        olc::vi2d screenSector = {0, 0};
+
+        // Draw each sector
+        for (screenSector.x = 0; screenSector.x < nSectorX; screenSector.x++)
+            for (screenSector.y = 0; screenSector.y < nSectorY; screenSector.y++) {
+                const SectorInfo &star = visibleSectors[screenSector.y * nSectorX + screenSector.x];
+
+                // If the star exists, draw it
+                if (star.starExists) {
+                    FillCircle(screenSector.x * SECTOR_SIZE + SECTOR_SIZE / 2,
+                               screenSector.y * SECTOR_SIZE + SECTOR_SIZE / 2,
+                               (int) star.starDiameter / (SECTOR_SIZE / 2), star.starColor);
+                }
+            }
+
+        if (orbitsEverywhere) drawVisibleOrbits(nSectorX, nSectorY);
+        // Stars still to come from the store have no orbits yet, so they are gathered again next time
+        if (tilesPending) visibleOrbitsRect = {0, 0, 0, 0};
+
+        SetDrawTarget(nullptr);
+    }
+
+    /**
+     * Fills visibleSectors from the tile store when it covers the whole view, otherwise from the cache,
+     * which has whatever the prefetcher got to first. Sectors of tiles still being read show empty until
+     * they arrive, unless systems are loaded synchronously, when the tiles are waited for
+     */
+    void getVisibleSectors(const SectorRect &rect) {
+        tilesPending = false;
+        if (!tilePager || !tileStore->covers(rect)) {
+            // The prefetcher's ring around the view stays cached too
+            sectorCache.getRect(rect, visibleSectors, uint32_t(std::max(prefetchDistance, 0)));
+            return;
+        }
+
+        visibleSectors.resize(size_t(rect.w) * rect.h);
+        int64_t currentIndex = -1;
+        std::shared_ptr<const tiles::DecodedTile> tile;
+        for (uint32_t j = 0; j < rect.h; j++)
+            for (uint32_t i = 0; i < rect.w; i++) {
+                const uint32_t x = rect.x + i, y = rect.y + j;
+                const int64_t index = tileStore->tileOf(x, y);
+                if (index != currentIndex) {
+                    currentIndex = index;
+                    tile = tilePager->find(uint64_t(index), !asyncSystems);
+                }
+                if (tile) visibleSectors[j * rect.w + i] = tile->info(x % tiles::TILE_SIZE, y % tiles::TILE_SIZE);
+                else {
+                    visibleSectors[j * rect.w + i] = SectorInfo();
+                    tilesPending = true;
+                }
+            }
+    }
+
+    /**
+     * Draws the planets of every visible system as dots circling their star, within its sector
+     */
+    void drawVisibleOrbits(int nSectorX, int nSectorY) {
+        OLC_PROFILE_ZONE("visible orbits");
+        // The bodies only change when the view moves, their positions every frame
+        const SectorRect view{(uint32_t) viewOffset.x, (uint32_t) viewOffset.y, (uint32_t) nSectorX,
+                              (uint32_t) nSectorY};
+        if (!(view == visibleOrbitsRect)) {
+            visibleOrbitsRect = view;
+            visiblePlanets.clear();
+            visibleSystems.clear();
+            for (int y = 0; y < nSectorY; y++)
+                for (int x = 0; x < nSectorX; x++) {
+                    if (!visibleSectors[y * nSectorX + x].starExists) continue;
+                    auto system = sectorCache.getOrGenerateFull(view.x + x, view.y + y);
+                    if (system->planets.empty()) continue;
+                    const size_t first = addPlanetOrbits(visiblePlanets, *system);
+                    visibleSystems.push_back({{x * SECTOR_SIZE + SECTOR_SIZE / 2, y * SECTOR_SIZE + SECTOR_SIZE / 2},
+                                              system, first});
+                }
+        }
+
+        visiblePlanets.update(orbitRenderTime);
+        for (const auto &system: visibleSystems) {
+            const float outermost = float(system.star->planets.back().distance);
+            for (size_t i = 0; i < system.star->planets.size(); i++) {
+                const size_t body = system.firstPlanet + i;
+                Draw(system.centre + orbitOffset(visiblePlanets.x[body], visiblePlanets.y[body], outermost,
+                                                 SECTOR_SIZE / 2 - 1), system.star->planets[i].color);
+            }
+        }
+    }
+
+    /**
+     * Where a body at (x, y) from its star goes on screen, with the outermost orbit at radius pixels.
+     * Distances are square rooted, so the inner planets clear the star while the outer ones still fit
+     */
+    static olc::vi2d orbitOffset(float x, float y, float outermost, float radius) {
+        const float distance = std::sqrt(x * x + y * y);
+        if (distance <= 0.0f) return {0, 0};
+        const float scale = radius * std::sqrt(distance / outermost) / distance;
+        return {(int) std::lround(x * scale), (int) std::lround(y * scale)};
+    }
+
+    /**
+     * Draws the hover ring and the selected system's window onto layer 0, which is otherwise see-through
+     */
+    void drawOverlay(const olc::vi2d &mouse, int nSectorX, int nSectorY) {
+        OLC_ALLOC_SCOPE("overlay");
+        OLC_PROFILE_ZONE("overlay");
+        SetDrawTarget(nullptr);
+        Clear(olc::BLANK);
+
+        if (mouse.x >= 0 && mouse.x < nSectorX && mouse.y >= 0 && mouse.y < nSectorY) {
+            const uint32_t sectorX = mouse.x + (uint32_t) viewOffset.x, sectorY = mouse.y + (uint32_t) viewOffset.y;
+            StarSystem hovered(sectorX, sectorY, false, sectorCache.starProbability(sectorX, sectorY));
+            if (hovered.starExists) {
+                DrawCircle(mouse.x * SECTOR_SIZE + SECTOR_SIZE / 2,
+                           mouse.y * SECTOR_SIZE + SECTOR_SIZE / 2,
+                           12, olc::BLUE);
+            }
+        }
+
+        if (starSelected) {
+            // Windows
+            FillRect(PLANETS_WINDOW_X, PLANETS_WINDOW_Y, PLANETS_WINDOW_W, PLANETS_WINDOW_H, olc::DARK_BLUE);
+            DrawRect(PLANETS_WINDOW_X, PLANETS_WINDOW_Y, PLANETS_WINDOW_W, PLANETS_WINDOW_H, olc::WHITE);
+
+            if (!selectedSystem) {
+                DrawString(PLANETS_WINDOW_X + 10, PLANETS_WINDOW_Y + 10, "Generating system...");
+                return;
+            }
+            const StarSystem &star = *selectedSystem;
+            if (orbitView) drawSystemOrbits(star);
+            else drawSystemRow(star);
+
+            // Display information for a selected planet
+            if (GetKey(olc::K1).bHeld && !star.planets.empty())
+                printPlanetInfo(star.planets[0], PLANETS_WINDOW_X + 10, PLANETS_WINDOW_Y - 140);
+            if (GetKey(olc::K2).bHeld && star.planets.size() > 1)
+                printPlanetInfo(star.planets[1], PLANETS_WINDOW_X + 10, PLANETS_WINDOW_Y - 140);
+            if (GetKey(olc::K3).bHeld && star.planets.size() > 2)
+                printPlanetInfo(star.planets[2], PLANETS_WINDOW_X + 10, PLANETS_WINDOW_Y - 140);
+            if (GetKey(olc::K4).bHeld && star.planets.size() > 3)
+                printPlanetInfo(star.planets[3], PLANETS_WINDOW_X + 10, PLANETS_WINDOW_Y - 140);
+            if (GetKey(olc::K5).bHeld && star.planets.size() > 4)
+                printPlanetInfo(star.planets[4], PLANETS_WINDOW_X + 10, PLANETS_WINDOW_Y - 140);
+            if (GetKey(olc::K6).bHeld && star.planets.size() > 5)
+                printPlanetInfo(star.planets[5], PLANETS_WINDOW_X + 10, PLANETS_WINDOW_Y - 140);
+            if (GetKey(olc::K7).bHeld && star.planets.size() > 6)
+                printPlanetInfo(star.planets[6], PLANETS_WINDOW_X + 10, PLANETS_WINDOW_Y - 140);
+            if (GetKey(olc::K8).bHeld && star.planets.size() > 7)
+                printPlanetInfo(star.planets[7], PLANETS_WINDOW_X + 10, PLANETS_WINDOW_Y - 140);
+            if (GetKey(olc::K9).bHeld && star.planets.size() > 8)
+                printPlanetInfo(star.planets[8], PLANETS_WINDOW_X + 10, PLANETS_WINDOW_Y - 140);
+        }
+    }
+
+    /**
+     * The selected system in the planet window, star on the left and planets in a row with their moons beneath
+     */
+    void drawSystemRow(const StarSystem &star) {
+        const double RATIO = 1.375;
+
+        // Star
+        olc::vi2d bodyPosition = {14, 356};
+        bodyPosition.x += (int) (star.starDiameter * RATIO);
+        FillCircle(bodyPosition, (int) (star.starDiameter * RATIO), star.starColor);
+        bodyPosition.x += (int) (star.starDiameter * RATIO) + 8;
+
+        // Draw planets
+        for (const auto &planet: star.planets) {
+            if (bodyPosition.x + planet.diameter >= PLANETS_WINDOW_W - 20) break;
+
+            bodyPosition.x += (int) planet.diameter;
+            const int radius = (int) (planet.diameter * 1.0);
+            SetPixelMode(olc::Pixel::MASK);
+            DrawSprite(bodyPosition - olc::vi2d{radius, radius}, getPlanetSurface(spriteCache, planet, radius));
+            SetPixelMode(olc::Pixel::NORMAL);
+
+            olc::vi2d moonPosition = bodyPosition;
+            moonPosition.y += (int) planet.diameter + 10;
+
+            // Draw moons
+            for (const auto &moon: planet.moons) {
+                if (moonPosition.y >= 450) break;
+                moonPosition.y += (int) moon;
+                FillCircle(moonPosition, (int) (moon * 1.0), olc::GREY);
+                moonPosition.y += (int) moon + 10;
+            }
+
+            bodyPosition.x += (int) planet.diameter + 8;
+        }
+    }
+
+    /**
+     * The selected system in the planet window with every planet and moon where its orbit has it now, the
+     * star in the middle
+     */
+    void drawSystemOrbits(const StarSystem &star) {
+        OLC_PROFILE_ZONE("system orbits");
+        if (orbitsBuiltFor != selectedSystem) {
+            orbitsBuiltFor = selectedSystem;
+            systemPlanets.clear();
+            systemMoons.clear();
+            addSystemOrbits(systemPlanets, systemMoons, star);
+        }
+        systemPlanets.update(orbitRenderTime);
+        systemMoons.update(orbitRenderTime);
+
+        const olc::vi2d centre = {PLANETS_WINDOW_X + PLANETS_WINDOW_W / 2, PLANETS_WINDOW_Y + PLANETS_WINDOW_H / 2};
+        FillCircle(centre, (int) (star.starDiameter / 4.0) + 2, star.starColor);
+        if (star.planets.empty()) return;
+
+        const float outermost = float(star.planets.back().distance);
+        const float radius = PLANETS_WINDOW_H / 2 - 20;
+        size_t moon = 0;
+        for (size_t i = 0; i < star.planets.size(); i++) {
+            const Planet &planet = star.planets[i];
+            const olc::vi2d position = centre + orbitOffset(systemPlanets.x[i], systemPlanets.y[i], outermost, radius);
+            const int planetRadius = std::max((int) (planet.diameter / 2.0), 2);
+            SetPixelMode(olc::Pixel::MASK);
+            DrawSprite(position - olc::vi2d{planetRadius, planetRadius},
+                       getPlanetSurface(spriteCache, planet, planetRadius));
+            SetPixelMode(olc::Pixel::NORMAL);
+
+            // Moons were added in planet order, at distances measured from the planet
+            for (size_t m = 0; m < planet.moons.size(); m++, moon++)
+                FillCircle(position + olc::vi2d{(int) std::lround(systemMoons.x[moon] * 0.2f),
+                                                (int) std::lround(systemMoons.y[moon] * 0.2f)},
+                           planet.moons[m] > 3.0 ? 1 : 0, olc::GREY);
+        }
+    }
+
+    /**
+     * Everything the view depends on, frames where it stays the same are skipped
+     */
+    struct ViewState {
+        uint32_t offsetX, offsetY;
+        olc::vi2d mouse;
+        bool starSelected;
+        olc::vi2d selectedStar;
+        bool systemReady;
+        uint32_t planetKeys;
+        bool orbitView;
+        bool orbitsEverywhere;
+
+        bool operator==(const ViewState &other) const {
+            return offsetX == other.offsetX && offsetY == other.offsetY && mouse == other.mouse &&
+                   starSelected == other.starSelected && selectedStar == other.selectedStar &&
+                   systemReady == other.systemReady && planetKeys == other.planetKeys &&
+                   orbitView == other.orbitView && orbitsEverywhere == other.orbitsEverywhere;
+        }
+    };
+
+    olc::vf2d previousOffset = {0, 0};
+    olc::vf2d viewOffset = {0, 0};
+    olc::vf2d velocity = {0, 0};
+    std::unique_ptr<GalaxyShape> galaxyShape;
+    SectorCache sectorCache;
+    std::unique_ptr<SectorPrefetcher> prefetcher;
+    std::vector<SectorInfo> visibleSectors;
+    std::unique_ptr<SystemLoader> systemLoader;
+    std::unique_ptr<tiles::TileStore> tileStore;
+    std::unique_ptr<tiles::TilePager> tilePager;
+    // Some visible tile was still being read when the stars were last drawn
+    bool tilesPending{false};
+    std::shared_ptr<SystemRequest> pendingSystem;
+    std::shared_ptr<const StarSystem> selectedSystem;
+
+    // Orbits are a function of time, which advances in ticks and is interpolated between them like the camera
+    double orbitTime{0.0}, previousOrbitTime{0.0}, orbitRenderTime{0.0};
+    std::shared_ptr<const StarSystem> orbitsBuiltFor;
+    OrbitBodies systemPlanets, systemMoons;
+
+    struct VisibleSystem {
+        olc::vi2d centre;
+        std::shared_ptr<const StarSystem> star;
+        size_t firstPlanet;
+    };
+    SectorRect visibleOrbitsRect{0, 0, 0, 0};
+    std::vector<VisibleSystem> visibleSystems;
+    // A sector is too small to show moons apart from their planet, so only planets go round here
+    OrbitBodies visiblePlanets;
+
+    /**
+     * Shows the system at position in the planet window, straight away if it is cached or loading is
+     * synchronous, otherwise once the loader has generated it. Systems in the tile store are read from it.
+     * A request still pending is dropped
+     */
+    void selectSystem(const olc::vi2d &position) {
+        selectedSystem.reset();
+        pendingSystem.reset();
+        // Stored systems take one band of their tile to inflate, quicker than handing them to the loader
+        if (tileStore && tileStore->tileOf(position.x, position.y) >= 0) {
+            selectedSystem = tileStore->readSystem(position.x, position.y);
+            return;
+        }
+        if (systemLoader) {
+            pendingSystem = systemLoader->request(position.x, position.y);
+            if (pendingSystem->ready()) {
+                selectedSystem = pendingSystem->get();
+                pendingSystem.reset();
+            }
+        } else
+            selectedSystem = sectorCache.getOrGenerateFull(position.x, position.y);
+    }
+    ViewState lastView{};
+    bool hasDrawn{false};
+    uint8_t starLayer{0};
+
+    uint32_t heldPlanetKeys() const {
+        uint32_t keys = 0;
+        for (int k = olc::K1; k <= olc::K9; k++)
+            if (GetKey(olc::Key(k)).bHeld) keys |= 1u << (k - olc::K1);
+        return keys;
+    }
+
+    void printPlanetInfo(const Planet &planet, const int offsetX, int offsetY) {
+        OLC_ALLOC_SCOPE("planet info");
+        OLC_PROFILE_ZONE("planet info");
+        FillRect(PLANETS_WINDOW_X, offsetY - 10 + 40, PLANETS_WINDOW_W, 100, olc::DARK_BLUE);
+        DrawRect(PLANETS_WINDOW_X, offsetY - 10 + 40, PLANETS_WINDOW_W, 100, olc::WHITE);
+
+        PlanetInfoText text;
+        formatPlanetInfo(planet, text);
+        DrawString({offsetX, offsetY + 40}, text.view());
+    }
+
+    // Room for the longest planet info, every mineral and gas included, with some to spare
+    using PlanetInfoText = FixedText<512>;
+
+    /**
+     * The planet window's text, one property per line
+     */
+    static void formatPlanetInfo(const Planet &planet, PlanetInfoText &text) {
+        text << "Distance from sun: " << planet.distance << " u" << "\nDiameter: " << planet.diameter << " u"
+             << "\nFlora: " << (planet.flora ? "Yes" : "No") << "\nMinerals: ";
+        if (planet.minerals.empty()) text << "None";
+        else for (const auto &mineral: planet.minerals) text << mineral << " ";
+        text << "\nWater: " << (planet.water ? "Yes" : "No") << "\nGasses: ";
+        if (planet.gasses.empty()) text << "None";
+        else for (const auto &gas: planet.gasses) text << gas << " ";
+        text << "\nTemperature: " << planet.temperature << " C"
+             << "\nPopulation: " << planet.population
+             << "\nRing: " << (planet.ring ? "Yes" : "No");
+    }
+};
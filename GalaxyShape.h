@@ -0,0 +1,128 @@
+#pragma once
+
+#include "Kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/**
+ * How likely each sector is to hold a star, shaped like a spiral galaxy centred on sector (0, 0): a dense
+ * bulge, a disc with arms winding out of it, dark voids scattered through, and a sparse halo beyond.
+ * The field is worked out once on a coarse grid, after which a sector costs a bilinear lookup
+ */
+class GalaxyShape {
+public:
+    static const int GRID = 256;
+
+    // Chance of a star well outside the disc, the flat galaxy has 1 in 20 everywhere
+    static constexpr float HALO_PROBABILITY = 0.002f;
+
+    /**
+     * radius is in sectors, coordinates wrap at 65536 like the generator's seeds, so it should stay well
+     * under 32768
+     */
+    explicit GalaxyShape(float radius = 2048.0f, int arms = 2, uint32_t seed = 0x5EED)
+            : radius(radius), scale(float(GRID - 1) / (2.0f * radius)), grid(size_t(GRID) * GRID) {
+        const float pitch = 0.3f;
+        for (int j = 0; j < GRID; j++)
+            for (int i = 0; i < GRID; i++) {
+                const float px = float(i) / float(GRID - 1) * 2.0f - 1.0f;
+                const float py = float(j) / float(GRID - 1) * 2.0f - 1.0f;
+                const float r = std::sqrt(px * px + py * py);
+                const float theta = std::atan2(py, px);
+
+                // Arms are logarithmic spirals, sharpened so the gaps between them thin out
+                const float phase = float(arms) * (theta - std::log(std::max(r, 0.01f)) / std::tan(pitch));
+                const float arm = std::pow(0.5f + 0.5f * std::cos(phase), 4.0f);
+                const float bulge = 4.0f * std::exp(-(r * r) / (0.15f * 0.15f));
+                const float disc = std::exp(-r / 0.35f) * (0.15f + 3.5f * arm);
+
+                // Voids where two octaves of coarse noise dip low
+                const float noise = 0.65f * valueNoise(px * 6.0f, py * 6.0f, seed) +
+                                    0.35f * valueNoise(px * 12.0f, py * 12.0f, seed + 1);
+                const float voids = std::min(std::max((noise - 0.25f) / 0.2f, 0.0f), 1.0f);
+
+                // Density 1 is the flat galaxy's 1 in 20
+                const float density = (bulge + disc * voids) * (r < 1.0f ? 1.0f : 0.0f);
+                grid[size_t(j) * GRID + i] = std::min(std::max(density / 20.0f, HALO_PROBABILITY), 0.5f);
+            }
+    }
+
+    /**
+     * The chance of a star in sector (x, y)
+     */
+    float probability(uint32_t x, uint32_t y) const {
+        const float gy = (float(int16_t(uint16_t(y))) + radius) * scale;
+        const float gx = (float(int16_t(uint16_t(x))) + radius) * scale;
+        if (!(gx >= 0.0f && gx < float(GRID - 1) && gy >= 0.0f && gy < float(GRID - 1))) return HALO_PROBABILITY;
+        return lookup(gx, gy);
+    }
+
+    /**
+     * The chances for the n sectors from (x0, y) rightwards, the same values probability gives
+     */
+    void probabilityRow(uint32_t x0, uint32_t y, int n, float *out) const {
+#if defined(KERNELS_AVX2)
+        if (cpuHasAVX2()) return probabilityRowAVX2(x0, y, n, out);
+#endif
+        for (int i = 0; i < n; i++) out[i] = probability(x0 + uint32_t(i), y);
+    }
+
+private:
+    float lookup(float gx, float gy) const {
+        const int ix = int(gx), iy = int(gy);
+        const float tx = gx - float(ix), ty = gy - float(iy);
+        const float *cell = &grid[size_t(iy) * GRID + ix];
+        const float ab = cell[0] + (cell[1] - cell[0]) * tx;
+        const float cd = cell[GRID] + (cell[GRID + 1] - cell[GRID]) * tx;
+        return ab + (cd - ab) * ty;
+    }
+
+#if defined(KERNELS_AVX2)
+    /**
+     * Eight sectors at a time, with the four corners of each cell gathered from the grid. Lanes outside it
+     * gather from cell 0 and are replaced by the halo
+     */
+    __attribute__((target("avx2"))) void probabilityRowAVX2(uint32_t x0, uint32_t y, int n, float *out) const {
+        const float gy = (float(int16_t(uint16_t(y))) + radius) * scale;
+        if (!(gy >= 0.0f && gy < float(GRID - 1))) {
+            std::fill(out, out + n, HALO_PROBABILITY);
+            return;
+        }
+        const int iy = int(gy);
+        const __m256 ty = _mm256_set1_ps(gy - float(iy));
+        const __m256 halo = _mm256_set1_ps(HALO_PROBABILITY);
+        const __m256 vRadius = _mm256_set1_ps(radius), vScale = _mm256_set1_ps(scale);
+        const __m256 limit = _mm256_set1_ps(float(GRID - 1));
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const float *row = &grid[size_t(iy) * GRID];
+
+        const int n8 = n & ~7;
+        for (int i = 0; i < n8; i += 8) {
+            // Sign extending the low 16 bits wraps x the same way the scalar cast does
+            __m256i sx = _mm256_add_epi32(_mm256_set1_epi32(int32_t(x0 + uint32_t(i))), lanes);
+            sx = _mm256_srai_epi32(_mm256_slli_epi32(sx, 16), 16);
+            const __m256 gx = _mm256_mul_ps(_mm256_add_ps(_mm256_cvtepi32_ps(sx), vRadius), vScale);
+            const __m256 inside = _mm256_and_ps(_mm256_cmp_ps(gx, _mm256_setzero_ps(), _CMP_GE_OQ),
+                                                _mm256_cmp_ps(gx, limit, _CMP_LT_OQ));
+
+            const __m256i ix = _mm256_and_si256(_mm256_cvttps_epi32(gx), _mm256_castps_si256(inside));
+            const __m256 tx = _mm256_sub_ps(gx, _mm256_cvtepi32_ps(ix));
+            const __m256i ix1 = _mm256_add_epi32(ix, _mm256_set1_epi32(1));
+            const __m256 a = _mm256_i32gather_ps(row, ix, 4), b = _mm256_i32gather_ps(row, ix1, 4);
+            const __m256 c = _mm256_i32gather_ps(row + GRID, ix, 4), d = _mm256_i32gather_ps(row + GRID, ix1, 4);
+            const __m256 ab = _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), tx));
+            const __m256 cd = _mm256_add_ps(c, _mm256_mul_ps(_mm256_sub_ps(d, c), tx));
+            const __m256 value = _mm256_add_ps(ab, _mm256_mul_ps(_mm256_sub_ps(cd, ab), ty));
+            _mm256_storeu_ps(out + i, _mm256_blendv_ps(halo, value, inside));
+        }
+        for (int i = n8; i < n; i++) out[i] = probability(x0 + uint32_t(i), y);
+    }
+#endif
+
+    const float radius;
+    const float scale;
+    std::vector<float> grid;
+};
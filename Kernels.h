@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KERNELS_AVX2
+#include <immintrin.h>
+#endif
+
+/**
+ * Whether the AVX2 kernels can run on this processor, asked once. Kernels are only compiled where
+ * KERNELS_AVX2 is defined
+ */
+inline bool cpuHasAVX2() {
+#if defined(KERNELS_AVX2)
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+    return hasAVX2;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Value noise at integer lattice points, in [0, 1)
+ */
+inline float latticeNoise(int32_t ix, int32_t iy, uint32_t seed) {
+    uint32_t h = (uint32_t(ix) * 0x27d4eb2du) ^ (uint32_t(iy) * 0x165667b1u) ^ seed;
+    h ^= h >> 15;
+    h *= 0x2c1b3c6du;
+    h ^= h >> 12;
+    return float(h >> 8) * (1.0f / 16777216.0f);
+}
+
+/**
+ * Eases t from 0 to 1 with zero slope at both ends
+ */
+inline float smoothStep(float t) { return t * t * (3.0f - 2.0f * t); }
+
+/**
+ * Lattice noise smoothly interpolated between the points around (x, y), in [0, 1)
+ */
+inline float valueNoise(float x, float y, uint32_t seed) {
+    const float fx = std::floor(x), fy = std::floor(y);
+    const int32_t ix = int32_t(fx), iy = int32_t(fy);
+    const float u = smoothStep(x - fx), v = smoothStep(y - fy);
+    const float a = latticeNoise(ix, iy, seed), b = latticeNoise(ix + 1, iy, seed);
+    const float c = latticeNoise(ix, iy + 1, seed), d = latticeNoise(ix + 1, iy + 1, seed);
+    const float ab = a + (b - a) * u, cd = c + (d - c) * u;
+    return ab + (cd - ab) * v;
+}
+
+#if defined(KERNELS_AVX2)
+/**
+ * latticeNoise for eight points at once, giving the same values
+ */
+__attribute__((target("avx2"))) inline __m256 latticeNoise8(__m256i ix, __m256i iy, __m256i seed) {
+    __m256i h = _mm256_xor_si256(_mm256_mullo_epi32(ix, _mm256_set1_epi32(0x27d4eb2d)),
+                                 _mm256_mullo_epi32(iy, _mm256_set1_epi32(0x165667b1)));
+    h = _mm256_xor_si256(h, seed);
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(0x2c1b3c6d));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 12));
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(h, 8)), _mm256_set1_ps(1.0f / 16777216.0f));
+}
+#endif
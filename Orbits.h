@@ -0,0 +1,208 @@
+#pragma once
+
+#include "StarSystem.h"
+#include "Kernels.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+constexpr float ORBIT_TWO_PI = 6.28318530717958647692f;
+
+/**
+ * sin and cos together, accurate to about 1e-6 over any range a float angle keeps its precision in.
+ * Reduces to a quarter turn around 0, then picks and negates the two short polynomials by quadrant
+ */
+inline void sinCosApprox(float x, float &s, float &c) {
+    const float k = std::nearbyint(x * 0.63661977236758134f);
+    const float r = (x - k * 1.5703125f) - k * 4.8382679490e-4f;
+    const float r2 = r * r;
+    const float ps = r + r * r2 * (-1.6666667e-1f + r2 * (8.3333333e-3f + r2 * -1.9841270e-4f));
+    const float pc = 1.0f + r2 * (-0.5f + r2 * (4.1666667e-2f + r2 * (-1.3888889e-3f + r2 * 2.4801587e-5f)));
+    const int q = int(k) & 3;
+    s = (q & 1) ? pc : ps;
+    c = (q & 1) ? ps : pc;
+    if (q & 2) s = -s;
+    if ((q + 1) & 2) c = -c;
+}
+
+/**
+ * Bodies on Kepler orbits around the origin, one array per property so the update streams through memory
+ * and runs several bodies per instruction. Positions are a function of time alone, nothing accumulates,
+ * so any time can be shown, including one between two ticks
+ */
+class OrbitBodies {
+public:
+    // Per body: orbit size and shape, orientation, where it was at time 0 and how fast it goes round
+    std::vector<float> semiMajor, semiMinor, eccentricity, cosPeriapsis, sinPeriapsis, meanAnomaly, meanMotion;
+    // Positions as of the last update
+    std::vector<float> x, y;
+
+    size_t size() const { return semiMajor.size(); }
+
+    void clear() {
+        for (auto *v: {&semiMajor, &semiMinor, &eccentricity, &cosPeriapsis, &sinPeriapsis, &meanAnomaly,
+                       &meanMotion, &x, &y})
+            v->clear();
+    }
+
+    /**
+     * Adds a body, mean motion follows Kepler's third law from gravity, returns its index
+     */
+    size_t add(float a, float e, float periapsis, float anomaly, float gravity) {
+        semiMajor.push_back(a);
+        semiMinor.push_back(a * std::sqrt(1.0f - e * e));
+        eccentricity.push_back(e);
+        cosPeriapsis.push_back(std::cos(periapsis));
+        sinPeriapsis.push_back(std::sin(periapsis));
+        meanAnomaly.push_back(anomaly);
+        meanMotion.push_back(gravity / (a * std::sqrt(a)));
+        x.push_back(0.0f);
+        y.push_back(0.0f);
+        return size() - 1;
+    }
+
+    /**
+     * Moves every body to where it is at time t
+     */
+    void update(double t) {
+#if defined(KERNELS_AVX2)
+        if (cpuHasAVX2()) return updateAVX2(t);
+#endif
+        updateScalar(t, 0);
+    }
+
+    void updateScalar(double t, size_t begin) {
+        const size_t n = size();
+        for (size_t i = begin; i < n; i++) {
+            // Mean anomaly, whole turns are dropped before the angle is formed so it keeps its precision
+            float turns = meanMotion[i] * float(t) * (1.0f / ORBIT_TWO_PI);
+            turns -= std::nearbyint(turns);
+            float m = meanAnomaly[i] + turns * ORBIT_TWO_PI;
+            m -= ORBIT_TWO_PI * std::nearbyint(m * (1.0f / ORBIT_TWO_PI));
+
+            // Kepler's equation by Newton's method, the orbits are near enough round for two steps
+            const float e = eccentricity[i];
+            float s, c;
+            sinCosApprox(m, s, c);
+            float E = m + e * s;
+            for (int step = 0; step < 2; step++) {
+                sinCosApprox(E, s, c);
+                E = E - (E - e * s - m) / (1.0f - e * c);
+            }
+            sinCosApprox(E, s, c);
+
+            const float px = semiMajor[i] * (c - e), py = semiMinor[i] * s;
+            x[i] = px * cosPeriapsis[i] - py * sinPeriapsis[i];
+            y[i] = px * sinPeriapsis[i] + py * cosPeriapsis[i];
+        }
+    }
+
+#if defined(KERNELS_AVX2)
+    __attribute__((target("avx2"))) static inline void sinCosApprox8(__m256 x, __m256 &s, __m256 &c) {
+        const __m256 k = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(0.63661977236758134f)),
+                                         _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        const __m256 r = _mm256_sub_ps(_mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(1.5703125f))),
+                                       _mm256_mul_ps(k, _mm256_set1_ps(4.8382679490e-4f)));
+        const __m256 r2 = _mm256_mul_ps(r, r);
+        __m256 ps = _mm256_add_ps(_mm256_set1_ps(8.3333333e-3f), _mm256_mul_ps(r2, _mm256_set1_ps(-1.9841270e-4f)));
+        ps = _mm256_add_ps(_mm256_set1_ps(-1.6666667e-1f), _mm256_mul_ps(r2, ps));
+        ps = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, r2), ps));
+        __m256 pc = _mm256_add_ps(_mm256_set1_ps(-1.3888889e-3f), _mm256_mul_ps(r2, _mm256_set1_ps(2.4801587e-5f)));
+        pc = _mm256_add_ps(_mm256_set1_ps(4.1666667e-2f), _mm256_mul_ps(r2, pc));
+        pc = _mm256_add_ps(_mm256_set1_ps(-0.5f), _mm256_mul_ps(r2, pc));
+        pc = _mm256_add_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(r2, pc));
+
+        // Odd quadrants swap sin and cos, the sign bits come straight from the quadrant's bits
+        const __m256i q = _mm256_cvtps_epi32(k);
+        const __m256 swap = _mm256_castsi256_ps(
+                _mm256_cmpeq_epi32(_mm256_and_si256(q, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+        const __m256 signS = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, _mm256_set1_epi32(2)), 30));
+        const __m256 signC = _mm256_castsi256_ps(_mm256_slli_epi32(
+                _mm256_and_si256(_mm256_add_epi32(q, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+        s = _mm256_xor_ps(_mm256_blendv_ps(ps, pc, swap), signS);
+        c = _mm256_xor_ps(_mm256_blendv_ps(pc, ps, swap), signC);
+    }
+
+    /**
+     * The same steps as updateScalar, eight bodies at a time, the rest go through updateScalar
+     */
+    __attribute__((target("avx2"))) void updateAVX2(double t) {
+        const size_t n = size(), n8 = n & ~size_t(7);
+        const __m256 twoPi = _mm256_set1_ps(ORBIT_TWO_PI), invTwoPi = _mm256_set1_ps(1.0f / ORBIT_TWO_PI);
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const float tf = float(t);
+
+        for (size_t i = 0; i < n8; i += 8) {
+            const __m256 motion = _mm256_loadu_ps(&meanMotion[i]);
+            __m256 turns = _mm256_mul_ps(_mm256_mul_ps(motion, _mm256_set1_ps(tf)), invTwoPi);
+            turns = _mm256_sub_ps(turns, _mm256_round_ps(turns, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+            __m256 m = _mm256_add_ps(_mm256_loadu_ps(&meanAnomaly[i]), _mm256_mul_ps(turns, twoPi));
+            m = _mm256_sub_ps(m, _mm256_mul_ps(twoPi, _mm256_round_ps(_mm256_mul_ps(m, invTwoPi),
+                                                                      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)));
+
+            const __m256 e = _mm256_loadu_ps(&eccentricity[i]);
+            __m256 s, c;
+            sinCosApprox8(m, s, c);
+            __m256 E = _mm256_add_ps(m, _mm256_mul_ps(e, s));
+            for (int step = 0; step < 2; step++) {
+                sinCosApprox8(E, s, c);
+                const __m256 f = _mm256_sub_ps(_mm256_sub_ps(E, _mm256_mul_ps(e, s)), m);
+                E = _mm256_sub_ps(E, _mm256_div_ps(f, _mm256_sub_ps(one, _mm256_mul_ps(e, c))));
+            }
+            sinCosApprox8(E, s, c);
+
+            const __m256 px = _mm256_mul_ps(_mm256_loadu_ps(&semiMajor[i]), _mm256_sub_ps(c, e));
+            const __m256 py = _mm256_mul_ps(_mm256_loadu_ps(&semiMinor[i]), s);
+            const __m256 cw = _mm256_loadu_ps(&cosPeriapsis[i]), sw = _mm256_loadu_ps(&sinPeriapsis[i]);
+            _mm256_storeu_ps(&x[i], _mm256_sub_ps(_mm256_mul_ps(px, cw), _mm256_mul_ps(py, sw)));
+            _mm256_storeu_ps(&y[i], _mm256_add_ps(_mm256_mul_ps(px, sw), _mm256_mul_ps(py, cw)));
+        }
+        updateScalar(t, n8);
+    }
+#endif
+};
+
+/**
+ * A fraction in [0, 1) from 16 bits of a seed
+ */
+inline float seedFraction(uint32_t seed, int shift) {
+    return float((seed >> shift) & 0xFFFF) / 65536.0f;
+}
+
+/**
+ * Adds the planets of a system, planet i is body first + i. Shapes and phases come from each planet's
+ * seed, so the generator is not drawn from. Returns the index of the first planet
+ */
+inline size_t addPlanetOrbits(OrbitBodies &planetOrbits, const StarSystem &star) {
+    const size_t first = planetOrbits.size();
+    for (const auto &planet: star.planets)
+        planetOrbits.add(float(planet.distance), 0.15f * seedFraction(planet.seed, 0),
+                         ORBIT_TWO_PI * seedFraction(planet.seed, 16), ORBIT_TWO_PI * seedFraction(planet.seed, 8),
+                         400.0f);
+    return first;
+}
+
+/**
+ * Adds the moons of a system in planet order. Moons circle their planet, at distances measured from it
+ */
+inline void addMoonOrbits(OrbitBodies &moonOrbits, const StarSystem &star) {
+    for (const auto &planet: star.planets) {
+        float distance = float(planet.diameter) + 4.0f;
+        for (size_t m = 0; m < planet.moons.size(); m++) {
+            const uint32_t seed = planetSeed(planet.seed, uint32_t(m), int(m) + 1);
+            distance += float(planet.moons[m]) * 2.0f + 4.0f;
+            moonOrbits.add(distance, 0.05f * seedFraction(seed, 0), ORBIT_TWO_PI * seedFraction(seed, 16),
+                           ORBIT_TWO_PI * seedFraction(seed, 8), 40.0f);
+        }
+    }
+}
+
+/**
+ * Adds the planets of a system and then their moons. Returns the index of the first planet
+ */
+inline size_t addSystemOrbits(OrbitBodies &planetOrbits, OrbitBodies &moonOrbits, const StarSystem &star) {
+    const size_t first = addPlanetOrbits(planetOrbits, star);
+    addMoonOrbits(moonOrbits, star);
+    return first;
+}
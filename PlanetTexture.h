@@ -0,0 +1,161 @@
+#pragma once
+
+#include "olcPixelGameEngine.h"
+#include "StarSystem.h"
+#include "Kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Several octaves of smoothed value noise along a row, out[i] is taken at (x0 + i * dx, y) and lies
+ * in [0, 1). Both versions do the same float operations in the same order, so they agree exactly.
+ * The scalar one fills out[begin] to out[end - 1]
+ */
+inline void surfaceNoiseRowScalar(float *out, int begin, int end, float x0, float dx, float y, uint32_t seed,
+                                  int octaves) {
+    for (int i = begin; i < end; i++) out[i] = 0.0f;
+    float frequency = 1.0f, amplitude = 1.0f, total = 0.0f;
+    for (int octave = 0; octave < octaves; octave++) {
+        const uint32_t octaveSeed = seed + uint32_t(octave) * 0x9E3779B9u;
+        const float py = y * frequency;
+        for (int i = begin; i < end; i++)
+            out[i] += valueNoise((x0 + float(i) * dx) * frequency, py, octaveSeed) * amplitude;
+        total += amplitude;
+        frequency *= 2.0f;
+        amplitude *= 0.5f;
+    }
+    for (int i = begin; i < end; i++) out[i] /= total;
+}
+
+#if defined(KERNELS_AVX2)
+/**
+ * Eight pixels at a time, the tail that does not fill a register goes through the scalar version
+ */
+__attribute__((target("avx2")))
+inline void surfaceNoiseRowAVX2(float *out, int n, float x0, float dx, float y, uint32_t seed, int octaves) {
+    const int n8 = n & ~7;
+    const __m256 lanes = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256 three = _mm256_set1_ps(3.0f), two = _mm256_set1_ps(2.0f);
+
+    for (int i = 0; i < n8; i += 8) {
+        const __m256 x = _mm256_add_ps(_mm256_set1_ps(x0),
+                                       _mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps(float(i)), lanes),
+                                                     _mm256_set1_ps(dx)));
+        __m256 sum = _mm256_setzero_ps();
+        float frequency = 1.0f, amplitude = 1.0f, total = 0.0f;
+        for (int octave = 0; octave < octaves; octave++) {
+            const __m256i octaveSeed = _mm256_set1_epi32(int32_t(seed + uint32_t(octave) * 0x9E3779B9u));
+            const float py = y * frequency;
+            const float fy = std::floor(py);
+            const __m256i iy = _mm256_set1_epi32(int32_t(fy));
+            const float ty = py - fy;
+            const __m256 v = _mm256_set1_ps(smoothStep(ty));
+
+            const __m256 px = _mm256_mul_ps(x, _mm256_set1_ps(frequency));
+            const __m256 fx = _mm256_floor_ps(px);
+            const __m256i ix = _mm256_cvttps_epi32(fx);
+            const __m256 tx = _mm256_sub_ps(px, fx);
+            const __m256 u = _mm256_mul_ps(_mm256_mul_ps(tx, tx), _mm256_sub_ps(three, _mm256_mul_ps(two, tx)));
+
+            const __m256i ix1 = _mm256_add_epi32(ix, one), iy1 = _mm256_add_epi32(iy, one);
+            const __m256 a = latticeNoise8(ix, iy, octaveSeed), b = latticeNoise8(ix1, iy, octaveSeed);
+            const __m256 c = latticeNoise8(ix, iy1, octaveSeed), d = latticeNoise8(ix1, iy1, octaveSeed);
+            const __m256 ab = _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), u));
+            const __m256 cd = _mm256_add_ps(c, _mm256_mul_ps(_mm256_sub_ps(d, c), u));
+            const __m256 value = _mm256_add_ps(ab, _mm256_mul_ps(_mm256_sub_ps(cd, ab), v));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(value, _mm256_set1_ps(amplitude)));
+
+            total += amplitude;
+            frequency *= 2.0f;
+            amplitude *= 0.5f;
+        }
+        _mm256_storeu_ps(out + i, _mm256_div_ps(sum, _mm256_set1_ps(total)));
+    }
+
+    surfaceNoiseRowScalar(out, n8, n, x0, dx, y, seed, octaves);
+}
+#endif
+
+/**
+ * Picks the AVX2 kernel when the processor has it
+ */
+inline void surfaceNoiseRow(float *out, int n, float x0, float dx, float y, uint32_t seed, int octaves) {
+#if defined(KERNELS_AVX2)
+    if (cpuHasAVX2()) return surfaceNoiseRowAVX2(out, n, x0, dx, y, seed, octaves);
+#endif
+    surfaceNoiseRowScalar(out, 0, n, x0, dx, y, seed, octaves);
+}
+
+/**
+ * Mixes a toward b, t from 0 to 1
+ */
+inline olc::Pixel mixColor(const olc::Pixel &a, const olc::Pixel &b, float t) {
+    return {uint8_t(a.r + (b.r - a.r) * t), uint8_t(a.g + (b.g - a.g) * t), uint8_t(a.b + (b.b - a.b) * t)};
+}
+
+/**
+ * Paints the planet's surface as a lit disc of the given radius into target, which must be 2 * radius + 1
+ * pixels square. Outside the disc is left transparent. Oceans come from water, polar ice from the cold,
+ * scorched ground from the heat, and green patches from flora
+ */
+inline void renderPlanetSurface(const Planet &planet, int radius, olc::Sprite &target) {
+    const int size = 2 * radius + 1;
+    const float scale = 3.0f / float(std::max(radius, 1));
+    std::vector<float> heights(size);
+
+    const float seaLevel = planet.water ? 0.48f : -1.0f;
+    const float iceLatitude = planet.temperature < 0.0 ? 1.0f + float(planet.temperature) / 300.0f : 2.0f;
+    const float scorch = std::min(std::max(float(planet.temperature - 100.0) / 200.0f, 0.0f), 1.0f);
+    const olc::Pixel deep(10, 40, 120), shallow(40, 100, 200), ice(235, 240, 250), burnt(150, 40, 20);
+    const olc::Pixel green(40, 140, 50);
+
+    for (int y = 0; y < size; y++) {
+        surfaceNoiseRow(heights.data(), size, 0.0f, scale, float(y) * scale, planet.seed, 4);
+        const float ny = float(y - radius) / float(radius);
+
+        for (int x = 0; x < size; x++) {
+            const float nx = float(x - radius) / float(radius);
+            const float r2 = nx * nx + ny * ny;
+            if (r2 > 1.0f) {
+                target.SetPixel(x, y, olc::BLANK);
+                continue;
+            }
+
+            const float h = heights[x];
+            olc::Pixel color;
+            if (h < seaLevel)
+                color = mixColor(deep, shallow, h / seaLevel);
+            else {
+                color = mixColor(olc::BLACK, planet.color, std::min(0.6f + (h - 0.3f), 1.0f));
+                if (planet.flora && h > 0.5f && h < 0.65f) color = mixColor(color, green, 0.6f);
+                color = mixColor(color, burnt, scorch);
+            }
+            if (std::fabs(ny) > iceLatitude) color = mixColor(color, ice, 0.85f);
+
+            // Lit from the star, which is drawn to the left
+            const float nz = std::sqrt(1.0f - r2);
+            const float light = std::min(std::max(0.3f + 0.8f * (0.8f * nz - 0.6f * nx), 0.15f), 1.0f);
+            target.SetPixel(x, y, mixColor(olc::BLACK, color, light));
+        }
+    }
+}
+
+/**
+ * Kinds of generated image kept in an olc::SpriteCache
+ */
+enum SpriteType : uint32_t {
+    SPRITE_PLANET_SURFACE = 1
+};
+
+/**
+ * The planet's surface at the given radius, rendered the first time it is asked for
+ */
+inline olc::Sprite *getPlanetSurface(olc::SpriteCache &cache, const Planet &planet, int radius) {
+    const int size = 2 * radius + 1;
+    return cache.Get({SPRITE_PLANET_SURFACE, planet.seed, {size, size}},
+                     [&](olc::Sprite &sprite) { renderPlanetSurface(planet, radius, sprite); });
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "olcPixelGameEngine.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A block of sectors to export, cut into bands of rows that are generated independently
+ */
+struct ExportRegion {
+    uint32_t originX = 0, originY = 0;
+    uint32_t width = 1024, height = 1024;
+    uint32_t bandRows = 16;
+
+    uint64_t bands() const { return (uint64_t(height) + bandRows - 1) / bandRows; }
+
+    uint64_t sectors() const { return uint64_t(width) * height; }
+};
+
+// Colours go out as 0xRRGGBB
+inline uint32_t exportColor(const olc::Pixel &color) { return uint32_t(color.r) << 16 | color.g << 8 | color.b; }
+
+/**
+ * Produces count chunks on worker threads and hands them to consume on the calling thread in order. At most
+ * window chunks exist at once, whether being produced or waiting their turn, so memory stays the same
+ * however many there are. Chunks are reused, produce must reset the one it is given
+ */
+template<typename Chunk>
+void produceInOrder(uint64_t count, unsigned threads, size_t window,
+                    const std::function<void(uint64_t, Chunk &)> &produce,
+                    const std::function<void(Chunk &)> &consume) {
+    window = std::max<size_t>(window, 1);
+    std::vector<std::unique_ptr<Chunk>> slots(window), pool;
+    for (size_t i = 0; i < window; i++) pool.push_back(std::make_unique<Chunk>());
+
+    std::mutex mutex;
+    std::condition_variable claimable, ready;
+    uint64_t nextClaim = 0, nextConsume = 0;
+
+    auto work = [&]() {
+        for (;;) {
+            uint64_t index;
+            std::unique_ptr<Chunk> chunk;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                // A chunk this far ahead of the one being consumed would have nowhere to go
+                claimable.wait(lock, [&]() { return nextClaim >= count || nextClaim < nextConsume + window; });
+                if (nextClaim >= count) return;
+                index = nextClaim++;
+                chunk = std::move(pool.back());
+                pool.pop_back();
+            }
+            produce(index, *chunk);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                slots[index % window] = std::move(chunk);
+            }
+            ready.notify_one();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < std::max(threads, 1u); t++) workers.emplace_back(work);
+
+    for (; nextConsume < count;) {
+        std::unique_ptr<Chunk> chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [&]() { return slots[nextConsume % window] != nullptr; });
+            chunk = std::move(slots[nextConsume % window]);
+        }
+        consume(*chunk);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pool.push_back(std::move(chunk));
+            nextConsume++;
+        }
+        claimable.notify_all();
+    }
+    for (auto &worker: workers) worker.join();
+}
@@ -0,0 +1,362 @@
+#pragma once
+
+#include "olcPixelGameEngine.h"
+#include "StarSystem.h"
+#include "GalaxyShape.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * A block of sectors, coordinates wrap around like the generator's seeds do
+ */
+struct SectorRect {
+    uint32_t x = 0, y = 0;
+    uint32_t w = 0, h = 0;
+
+    bool contains(uint32_t sx, uint32_t sy) const { return sx - x < w && sy - y < h; }
+
+    // The rect with margin more sectors on every side
+    SectorRect grown(uint32_t margin) const { return {x - margin, y - margin, w + 2 * margin, h + 2 * margin}; }
+
+    bool operator==(const SectorRect &other) const {
+        return x == other.x && y == other.y && w == other.w && h == other.h;
+    }
+};
+
+/**
+ * What the galaxy view needs of a sector, plus the full system once something generated it
+ */
+struct SectorInfo {
+    bool starExists = false;
+    double starDiameter = 0.0;
+    olc::Pixel starColor = olc::WHITE;
+    std::shared_ptr<const StarSystem> full;
+};
+
+/**
+ * Generated sectors, shared between the engine thread and the prefetcher
+ */
+class SectorCache {
+public:
+    explicit SectorCache(size_t capacity = 1 << 16) : capacity(capacity) {
+        sectors.reserve(capacity);
+    }
+
+    /**
+     * Shapes where stars are, nullptr for the flat galaxy. Set it before anything is generated, the
+     * shape must outlive the cache
+     */
+    void setShape(const GalaxyShape *galaxyShape) { shape = galaxyShape; }
+
+    /**
+     * The chance of a star in a sector, for StarSystem, negative in the flat galaxy
+     */
+    float starProbability(uint32_t x, uint32_t y) const { return shape ? shape->probability(x, y) : -1.0f; }
+
+    /**
+     * Fills out with the sectors in rect, row by row, generating any the cache is missing. Once over
+     * capacity, sectors further than keepMargin outside rect are dropped, which should cover whatever is
+     * prefetched around it. Engine thread only
+     */
+    void getRect(const SectorRect &rect, std::vector<SectorInfo> &out, uint32_t keepMargin = 0) {
+        out.resize(size_t(rect.w) * rect.h);
+        misses.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (uint32_t j = 0; j < rect.h; j++)
+                for (uint32_t i = 0; i < rect.w; i++) {
+                    auto found = sectors.find(key(rect.x + i, rect.y + j));
+                    if (found != sectors.end()) out[j * rect.w + i] = found->second;
+                    else misses.push_back(j * rect.w + i);
+                }
+        }
+        hits += out.size() - misses.size();
+        missed += misses.size();
+        if (misses.empty()) return;
+
+        // The shape is looked up a row at a time, which goes eight sectors per instruction
+        if (shape) {
+            probabilities.resize(out.size());
+            for (uint32_t j = 0; j < rect.h; j++)
+                shape->probabilityRow(rect.x, rect.y + j, int(rect.w), &probabilities[j * rect.w]);
+        }
+        for (uint32_t index: misses)
+            out[index] = generate(rect.x + index % rect.w, rect.y + index / rect.w, false,
+                                  shape ? probabilities[index] : -1.0f);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint32_t index: misses) sectors.emplace(key(rect.x + index % rect.w, rect.y + index / rect.w), out[index]);
+        if (sectors.size() > capacity) trim(rect.grown(keepMargin));
+    }
+
+    /**
+     * The full system of a sector if it has already been generated, otherwise nullptr
+     */
+    std::shared_ptr<const StarSystem> getFull(uint32_t x, uint32_t y) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = sectors.find(key(x, y));
+        return found != sectors.end() ? found->second.full : nullptr;
+    }
+
+    /**
+     * The full system of a sector, generated and cached first if need be
+     */
+    std::shared_ptr<const StarSystem> getOrGenerateFull(uint32_t x, uint32_t y) {
+        if (auto full = getFull(x, y)) return full;
+        auto full = std::make_shared<const StarSystem>(x, y, true, starProbability(x, y));
+        SectorInfo info{full->starExists, full->starDiameter, full->starColor, full};
+        std::lock_guard<std::mutex> lock(mutex);
+        sectors[key(x, y)] = std::move(info);
+        return full;
+    }
+
+    /**
+     * Generates a sector unless it is cached already, with its full system if asked for. Returns
+     * whether anything was generated
+     */
+    bool prefetch(uint32_t x, uint32_t y, bool full) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = sectors.find(key(x, y));
+            if (found != sectors.end() && (!full || !found->second.starExists || found->second.full)) return false;
+        }
+
+        SectorInfo info = generate(x, y, full, starProbability(x, y));
+        std::lock_guard<std::mutex> lock(mutex);
+        sectors[key(x, y)] = std::move(info);
+        prefetched++;
+        return true;
+    }
+
+    /**
+     * Once over capacity, drops every sector outside keep
+     */
+    void trimOutside(const SectorRect &keep) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (sectors.size() > capacity) trim(keep);
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return sectors.size();
+    }
+
+    // Sectors found by getRect, generated by getRect, and generated ahead of time
+    std::atomic<uint64_t> hits{0}, missed{0}, prefetched{0};
+
+private:
+    static uint64_t key(uint32_t x, uint32_t y) { return uint64_t(x) << 32 | y; }
+
+    static SectorInfo generate(uint32_t x, uint32_t y, bool full, float probability) {
+        SectorInfo info;
+        if (full) {
+            auto star = std::make_shared<const StarSystem>(x, y, true, probability);
+            info.starExists = star->starExists;
+            info.starDiameter = star->starDiameter;
+            info.starColor = star->starColor;
+            if (star->starExists) info.full = std::move(star);
+        } else {
+            StarSystem star(x, y, false, probability);
+            info.starExists = star.starExists;
+            info.starDiameter = star.starDiameter;
+            info.starColor = star.starColor;
+        }
+        return info;
+    }
+
+    void trim(const SectorRect &keep) {
+        for (auto it = sectors.begin(); it != sectors.end();) {
+            if (keep.contains(uint32_t(it->first >> 32), uint32_t(it->first))) ++it;
+            else it = sectors.erase(it);
+        }
+    }
+
+    mutable std::mutex mutex;
+    std::unordered_map<uint64_t, SectorInfo> sectors;
+    size_t capacity;
+    const GalaxyShape *shape = nullptr;
+    std::vector<uint32_t> misses;
+    std::vector<float> probabilities;
+};
+
+/**
+ * Generates the sectors the camera is heading for on a background thread, nearest first, so they are
+ * cached by the time they scroll into view
+ */
+class SectorPrefetcher {
+public:
+    /**
+     * Generates up to distance sectors past the edge of the view in the direction of travel, with
+     * their full systems too if full is set, so selecting a star ahead costs nothing either
+     */
+    SectorPrefetcher(SectorCache &cache, int distance, bool full)
+            : cache(cache), distance(distance), full(full), thread(&SectorPrefetcher::run, this) {}
+
+    ~SectorPrefetcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        wake.notify_one();
+        thread.join();
+    }
+
+    SectorPrefetcher(const SectorPrefetcher &) = delete;
+
+    /**
+     * Tells the prefetcher where the view is and which way it moves, cheap to call every frame
+     */
+    void update(const SectorRect &view, const olc::vf2d &velocity) {
+        const olc::vi2d direction = {(velocity.x > 0) - (velocity.x < 0), (velocity.y > 0) - (velocity.y < 0)};
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (view == request.view && direction == request.direction) return;
+            request = {view, direction};
+            generation++;
+        }
+        wake.notify_one();
+    }
+
+private:
+    struct Request {
+        SectorRect view;
+        olc::vi2d direction{0, 0};
+    };
+
+    void run() {
+        uint64_t seen = 0;
+        for (;;) {
+            Request current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() { return quit || generation != seen; });
+                if (quit) return;
+                seen = generation;
+                current = request;
+            }
+            if (current.direction == olc::vi2d{0, 0}) continue;
+
+            // Each step moves one sector further along, a newer request abandons the rest
+            for (int step = 1; step <= distance && generation == seen; step++) {
+                SectorRect ahead = current.view;
+                ahead.x += current.direction.x * step;
+                ahead.y += current.direction.y * step;
+                for (uint32_t j = 0; j < ahead.h && generation == seen; j++)
+                    for (uint32_t i = 0; i < ahead.w; i++)
+                        if (!current.view.contains(ahead.x + i, ahead.y + j))
+                            cache.prefetch(ahead.x + i, ahead.y + j, full);
+            }
+
+            // Keep what is on screen and everything within reach of it
+            cache.trimOutside(current.view.grown(uint32_t(distance)));
+        }
+    }
+
+    SectorCache &cache;
+    const int distance;
+    const bool full;
+    std::mutex mutex;
+    std::condition_variable wake;
+    Request request;
+    std::atomic<uint64_t> generation{0};
+    bool quit = false;
+    std::thread thread;
+};
+
+/**
+ * A full system generated in the background, the result is nullptr if the request was cancelled
+ */
+class SystemRequest {
+public:
+    SystemRequest(uint32_t x, uint32_t y) : x(x), y(y), result(promise.get_future().share()) {}
+
+    const uint32_t x, y;
+
+    bool ready() const { return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+
+    // Blocks until the system is ready
+    std::shared_ptr<const StarSystem> get() const { return result.get(); }
+
+private:
+    friend class SystemLoader;
+    std::promise<std::shared_ptr<const StarSystem>> promise;
+    std::shared_future<std::shared_ptr<const StarSystem>> result;
+};
+
+/**
+ * Generates full systems on a background thread, one request at a time. Only the latest request
+ * matters, so a new one cancels any still waiting
+ */
+class SystemLoader {
+public:
+    explicit SystemLoader(SectorCache &cache) : cache(cache), thread(&SystemLoader::run, this) {}
+
+    ~SystemLoader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+            cancelQueued();
+        }
+        wake.notify_one();
+        thread.join();
+    }
+
+    SystemLoader(const SystemLoader &) = delete;
+
+    /**
+     * Starts generating the system at (x, y), systems already in the cache are ready straight away
+     */
+    std::shared_ptr<SystemRequest> request(uint32_t x, uint32_t y) {
+        auto request = std::make_shared<SystemRequest>(x, y);
+        if (auto full = cache.getFull(x, y)) {
+            request->promise.set_value(std::move(full));
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelQueued();
+            return request;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelQueued();
+            queue.push_back(request);
+        }
+        wake.notify_one();
+        return request;
+    }
+
+private:
+    void cancelQueued() {
+        for (auto &stale: queue) stale->promise.set_value(nullptr);
+        queue.clear();
+    }
+
+    void run() {
+        for (;;) {
+            std::shared_ptr<SystemRequest> next;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() { return quit || !queue.empty(); });
+                if (quit) return;
+                next = std::move(queue.front());
+                queue.pop_front();
+            }
+            // A request running when it goes stale still finishes, its system stays cached
+            next->promise.set_value(cache.getOrGenerateFull(next->x, next->y));
+        }
+    }
+
+    SectorCache &cache;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::shared_ptr<SystemRequest>> queue;
+    bool quit = false;
+    std::thread thread;
+};
@@ -0,0 +1,222 @@
+#pragma once
+
+#include "olcPixelGameEngine.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+constexpr uint32_t starColorsARGB[8] = {
+        0xFFFFFFFF, 0xFFD9FFFF, 0xFFA3FFFF, 0xFFFFC8C8,
+        0xFFFFCB9D, 0xFF9F9FFF, 0xFF415EFF, 0xFF28199D
+};
+
+constexpr uint32_t planetColorsARGB[8] = {
+        0xFF042d63, 0xFFf87936, 0xFFe1eff0, 0xFF13ee3f,
+        0xFFB9dec0, 0xFFDeb9dd, 0xFFDddeb9, 0xFFE87896
+};
+
+constexpr std::array<std::string_view, 7> MINERALS = {
+        "Iron", "Aluminum", "Calcium", "Potassium", "Zinc", "Sodium", "Uranium"
+};
+
+constexpr std::array<std::string_view, 6> GASSES = {"He", "O2", "N2", "H2", "CH4", "CO2"};
+
+/**
+ * For every set of up to 8 catalog entries, as a bitmask, how many it holds and where its n-th one is
+ */
+struct CatalogMaskTable {
+    std::array<uint8_t, 256> count{};
+    std::array<std::array<uint8_t, 8>, 256> nth{};
+};
+
+constexpr CatalogMaskTable makeCatalogMaskTable() {
+    CatalogMaskTable table{};
+    for (uint32_t mask = 0; mask < 256; mask++) {
+        uint8_t found = 0;
+        for (uint8_t bit = 0; bit < 8; bit++)
+            if (mask & (1u << bit)) table.nth[mask][found++] = bit;
+        table.count[mask] = found;
+    }
+    return table;
+}
+
+constexpr CatalogMaskTable catalogMasks = makeCatalogMaskTable();
+
+static_assert(MINERALS.size() <= 8 && GASSES.size() <= 8, "Catalog masks hold up to 8 entries");
+
+/**
+ * Entries picked from a catalog, in the order they were picked
+ */
+class CatalogPicks {
+public:
+    void push_back(std::string_view name) { names[count++] = name; }
+
+    bool empty() const { return count == 0; }
+
+    size_t size() const { return count; }
+
+    const std::string_view *begin() const { return names.data(); }
+
+    const std::string_view *end() const { return names.data() + count; }
+
+private:
+    std::array<std::string_view, 8> names{};
+    uint8_t count = 0;
+};
+
+/**
+ * A planet with many properties
+ */
+class Planet {
+public:
+    olc::Pixel color{0xffBb9910};
+    double distance{0};
+    double diameter{0};
+    bool flora{false};
+    CatalogPicks minerals{};
+    bool water{false};
+    CatalogPicks gasses{};
+    double temperature{0};
+    double population{0};
+    bool ring = false;
+    std::vector<double> moons;
+    // Seeds what is derived from the planet outside the generator, its surface for one
+    uint32_t seed{0};
+};
+
+/**
+ * A pseudo random number generator, seeded per sector so every visit regenerates the same system
+ */
+class LehmerGenerator {
+public:
+    explicit LehmerGenerator(uint32_t seed) : lehmerState(seed) {}
+
+    uint32_t Lehmer32() {
+        lehmerState += 0xe120fc15;
+        uint64_t tmp;
+        tmp = (uint64_t) lehmerState * 0x4a39b70d;
+        uint32_t m1 = (tmp >> 32) ^ tmp;
+        tmp = (uint64_t) m1 * 0x12fad5c9;
+        uint32_t m2 = (tmp >> 32) ^ tmp;
+        return m2;
+    }
+
+    int rndInt(int min, int max) {
+        return (int) (Lehmer32() % (max - min)) + min;
+    }
+
+    double rndDouble(double min, double max) {
+        return ((double) Lehmer32() / (double) (0x7FFFFFFF)) * (max - min) + min;
+    }
+
+private:
+    uint32_t lehmerState = 0;
+};
+
+/**
+ * Mixes a sector and planet index into a seed, without drawing from the sector's generator
+ */
+inline uint32_t planetSeed(uint32_t x, uint32_t y, int index) {
+    uint32_t h = ((x & 0xFFFF) << 16 | (y & 0xFFFF)) ^ (uint32_t(index) * 0x9E3779B9u);
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ * Star system, that might contain planets
+ */
+class StarSystem : private LehmerGenerator {
+public:
+    bool starExists = false;
+    double starDiameter = 0.0f;
+    olc::Pixel starColor = olc::WHITE;
+    std::vector<Planet> planets;
+
+    /**
+     * An empty sector, for systems read back from storage rather than generated
+     */
+    StarSystem() : LehmerGenerator(0) {}
+
+    /**
+     * starProbability is the chance of the sector holding a star, from a GalaxyShape say. Left negative,
+     * every sector has the same 1 in 20 chance. Either way the test takes one draw, so what follows it
+     * is the same
+     */
+    StarSystem(uint32_t x, uint32_t y, bool GenerateFullSystem = false, float starProbability = -1.0f)
+            : LehmerGenerator((x & 0xFFFF) << 16 | (y & 0xFFFF)) {
+
+        if (starProbability < 0.0f) starExists = rndInt(0, 20) == 1;
+        else starExists = float(Lehmer32() >> 8) < starProbability * 16777216.0f;
+        if (!starExists) return;
+
+        starDiameter = rndDouble(10., 40.);
+        starColor.n = starColorsARGB[rndInt(0, 8)];
+
+        if (!GenerateFullSystem) return;
+        OLC_PROFILE_ZONE("full system");
+
+        double dDistanceFromStar = rndDouble(60.0f, 200.0f);
+        int nPlanets = rndInt(0, 10);
+
+        // Minerals and gasses still on offer, a pick is taken out for the rest of the system
+        uint32_t mineralsLeft = (1u << MINERALS.size()) - 1, gassesLeft = (1u << GASSES.size()) - 1;
+
+        // Generate planet properties
+        for (int i = 0; i < nPlanets; i++) {
+            Planet p;
+
+            p.seed = planetSeed(x, y, i);
+
+            p.color = planetColorsARGB[rndInt(0, 8)];
+
+            p.distance = dDistanceFromStar;
+
+            dDistanceFromStar += rndDouble(20.0f, 200.0f);
+
+            p.diameter = rndDouble(5.0f, 20.0f);
+
+            // Minerals
+            auto numOfMinerals = rndInt(0, catalogMasks.count[mineralsLeft] - 1);
+            while (numOfMinerals > 0) {
+                auto pick = catalogMasks.nth[mineralsLeft][rndInt(0, catalogMasks.count[mineralsLeft])];
+                p.minerals.push_back(MINERALS[pick]);
+                mineralsLeft &= ~(1u << pick);
+                numOfMinerals--;
+            }
+
+            p.water = (rndInt(0, 10) == 1);
+
+            // Gasses
+            auto numOfGasses = rndInt(0, catalogMasks.count[gassesLeft] - 1);
+            while (numOfGasses > 0) {
+                auto pick = catalogMasks.nth[gassesLeft][rndInt(0, catalogMasks.count[gassesLeft])];
+                p.gasses.push_back(GASSES[pick]);
+                gassesLeft &= ~(1u << pick);
+                numOfGasses--;
+            }
+
+            p.temperature = rndInt(-273, 300);
+
+            // Have a possibility of fauna only if there is water and right temperature
+            if (p.water && p.temperature > 0 && p.temperature < 50)
+                p.flora = (rndInt(0, 2) == 1);
+
+            p.population = std::max(rndInt(-10000000, 9000000), 0);
+
+            p.ring = rndInt(0, 10) == 1;
+
+            int nMoons = std::max(rndInt(-5, 5), 0);
+            for (int n = 0; n < nMoons; n++) {
+                p.moons.push_back(rndDouble(1.0, 5.0));
+            }
+            planets.push_back(p);
+        }
+    }
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "StarSystem.h"
+#include "RegionExport.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * A band's worth of output text. Capacity is kept between bands, so once warmed up nothing is allocated.
+ * Doubles are written in their shortest form that reads back exactly
+ */
+class TextChunk {
+public:
+    std::string text;
+
+    TextChunk &operator<<(std::string_view value) {
+        text.append(value);
+        return *this;
+    }
+
+    TextChunk &operator<<(const char *value) { return *this << std::string_view(value); }
+
+    TextChunk &operator<<(char value) {
+        text.push_back(value);
+        return *this;
+    }
+
+    template<typename T, std::enable_if_t<std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+                                          !std::is_same_v<T, char>, int> = 0>
+    TextChunk &operator<<(T value) {
+        char digits[32];
+        const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        text.append(digits, result.ptr);
+        return *this;
+    }
+
+    TextChunk &operator<<(bool value) { return *this << (value ? std::string_view("true") : "false"); }
+};
+
+enum class TextFormat {
+    CSV, NDJSON
+};
+
+// One row per planet, stars without planets get a single row with the planet columns left empty
+constexpr std::string_view csvHeader = "sector_x,sector_y,star_diameter,star_color,planet,color,distance,diameter,"
+                                       "temperature,population,flora,water,ring,minerals,gasses,moons\n";
+
+/**
+ * Names joined by separator, or a JSON array of them
+ */
+inline void writeCatalogPicks(TextChunk &out, const CatalogPicks &picks, TextFormat format) {
+    if (format == TextFormat::NDJSON) out << '[';
+    bool first = true;
+    for (const auto &name: picks) {
+        if (!first) out << (format == TextFormat::NDJSON ? ',' : ';');
+        if (format == TextFormat::NDJSON) out << '"' << name << '"';
+        else out << name;
+        first = false;
+    }
+    if (format == TextFormat::NDJSON) out << ']';
+}
+
+inline void writeSystemCSV(TextChunk &out, uint32_t x, uint32_t y, const StarSystem &star) {
+    const uint32_t starColor = exportColor(star.starColor);
+    if (star.planets.empty()) {
+        out << x << ',' << y << ',' << star.starDiameter << ',' << starColor << ",,,,,,,,,,,,\n";
+        return;
+    }
+    for (size_t i = 0; i < star.planets.size(); i++) {
+        const Planet &planet = star.planets[i];
+        out << x << ',' << y << ',' << star.starDiameter << ',' << starColor << ',' << uint32_t(i) << ','
+            << exportColor(planet.color) << ',' << planet.distance
+            << ',' << planet.diameter << ',' << planet.temperature << ',' << planet.population << ','
+            << planet.flora << ',' << planet.water << ',' << planet.ring << ',';
+        writeCatalogPicks(out, planet.minerals, TextFormat::CSV);
+        out << ',';
+        writeCatalogPicks(out, planet.gasses, TextFormat::CSV);
+        out << ',' << uint32_t(planet.moons.size()) << '\n';
+    }
+}
+
+inline void writeSystemNDJSON(TextChunk &out, uint32_t x, uint32_t y, const StarSystem &star) {
+    const uint32_t starColor = exportColor(star.starColor);
+    out << "{\"x\":" << x << ",\"y\":" << y << ",\"diameter\":" << star.starDiameter << ",\"color\":" << starColor
+        << ",\"planets\":[";
+    for (size_t i = 0; i < star.planets.size(); i++) {
+        const Planet &planet = star.planets[i];
+        if (i > 0) out << ',';
+        out << "{\"color\":" << exportColor(planet.color)
+            << ",\"distance\":" << planet.distance << ",\"diameter\":" << planet.diameter
+            << ",\"temperature\":" << planet.temperature << ",\"population\":" << planet.population
+            << ",\"flora\":" << planet.flora << ",\"water\":" << planet.water << ",\"ring\":" << planet.ring
+            << ",\"minerals\":";
+        writeCatalogPicks(out, planet.minerals, TextFormat::NDJSON);
+        out << ",\"gasses\":";
+        writeCatalogPicks(out, planet.gasses, TextFormat::NDJSON);
+        out << ",\"moons\":[";
+        for (size_t m = 0; m < planet.moons.size(); m++) {
+            if (m > 0) out << ',';
+            out << planet.moons[m];
+        }
+        out << "]}";
+    }
+    out << "]}\n";
+}
+
+inline void generateTextChunk(const ExportRegion &region, uint64_t band, TextFormat format, TextChunk &chunk) {
+    chunk.text.clear();
+    const uint32_t rowEnd = uint32_t(std::min<uint64_t>(region.height, (band + 1) * region.bandRows));
+    for (uint32_t row = uint32_t(band * region.bandRows); row < rowEnd; row++)
+        for (uint32_t column = 0; column < region.width; column++) {
+            const uint32_t x = region.originX + column, y = region.originY + row;
+            const StarSystem star(x, y, true);
+            if (!star.starExists) continue;
+            if (format == TextFormat::CSV) writeSystemCSV(chunk, x, y, star);
+            else writeSystemNDJSON(chunk, x, y, star);
+        }
+}
+
+/**
+ * Streams every star in the region to out in sector order, as CSV rows or NDJSON lines. Bands are
+ * written into per-thread chunks and flushed in order, a few per thread in memory at a time. Returns the
+ * bytes written, or -1 if writing failed
+ */
+inline int64_t exportText(const ExportRegion &region, unsigned threads, TextFormat format, std::FILE *out) {
+    int64_t written = 0;
+    bool failed = false;
+    if (format == TextFormat::CSV) {
+        failed |= std::fwrite(csvHeader.data(), 1, csvHeader.size(), out) != csvHeader.size();
+        written += int64_t(csvHeader.size());
+    }
+
+    produceInOrder<TextChunk>(
+            region.bands(), threads, size_t(threads) * 2,
+            [&](uint64_t band, TextChunk &chunk) { generateTextChunk(region, band, format, chunk); },
+            [&](TextChunk &chunk) {
+                failed |= std::fwrite(chunk.text.data(), 1, chunk.text.size(), out) != chunk.text.size();
+                written += int64_t(chunk.text.size());
+            });
+    failed |= std::fflush(out) != 0;
+    return failed ? -1 : written;
+}
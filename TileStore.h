@@ -0,0 +1,516 @@
+#pragma once
+
+#include "StarSystem.h"
+#include "RegionExport.h"
+#include "SectorCache.h"
+#include "GalaxyShape.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <bitset>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Pre-generated sectors on disk, in tiles of 256x256. Each tile starts with a bitmap of which sectors hold
+ * a star, stored as is so existence is read straight from the file. The galaxy view only needs each star's
+ * size and colour, which are deflated on their own, and full systems are deflated in bands of 16 rows so
+ * showing one inflates a sixteenth of the tile. A fixed size index right after the header finds any tile
+ * with one seek
+ *
+ * Header:  "PUTILES1", then uint32 version, first tile x and y, tiles across and down, and 1 if the stars
+ *          were placed by the default GalaxyShape
+ * Index:   per tile, row by row, uint64 offset, uint32 bytes and uint32 stars
+ * Tile:    the 8 KB bitmap, bit y * 256 + x, then a table of 17 blocks, each uint32 offset from the tile's
+ *          start, deflated size and inflated size. Block 0 has every star's diameter and colour, block
+ *          1 + b the systems of rows 16 b on, starting with the uint32 offset of each one's record. Stars
+ *          go in bitmap order throughout
+ */
+namespace tiles {
+    const int TILE_BITS = 8;
+    const uint32_t TILE_SIZE = 1u << TILE_BITS;
+    const uint32_t BAND_ROWS = 16;
+    const uint32_t BANDS = TILE_SIZE / BAND_ROWS;
+    const size_t BITMAP_BYTES = TILE_SIZE * TILE_SIZE / 8;
+    const size_t BAND_BITMAP_BYTES = BITMAP_BYTES / BANDS;
+    const size_t BLOCK_ENTRY_BYTES = 12;
+    const size_t TABLE_BYTES = (1 + BANDS) * BLOCK_ENTRY_BYTES;
+    const size_t LIGHT_RECORD_BYTES = 12;
+    const uint32_t VERSION = 1;
+    const size_t HEADER_BYTES = 32;
+    const size_t INDEX_ENTRY_BYTES = 16;
+
+    struct Header {
+        uint32_t tileX = 0, tileY = 0;
+        uint32_t tilesW = 0, tilesH = 0;
+        bool shaped = false;
+
+        uint64_t tiles() const { return uint64_t(tilesW) * tilesH; }
+    };
+
+    struct IndexEntry {
+        uint64_t offset = 0;
+        uint32_t bytes = 0, stars = 0;
+    };
+
+    struct BlockEntry {
+        uint32_t offset = 0, compressedSize = 0, packedSize = 0;
+    };
+
+    template<typename T>
+    inline void put(std::vector<uint8_t> &out, T value) {
+        out.resize(out.size() + sizeof(T));
+        std::memcpy(&out[out.size() - sizeof(T)], &value, sizeof(T));
+    }
+
+    template<typename T>
+    inline T get(const uint8_t *&in) {
+        T value;
+        std::memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return value;
+    }
+
+    template<size_t N>
+    inline void putPicks(std::vector<uint8_t> &out, const CatalogPicks &picks,
+                         const std::array<std::string_view, N> &catalog) {
+        put<uint8_t>(out, uint8_t(picks.size()));
+        for (const auto &name: picks) put<uint8_t>(out, uint8_t(std::find(catalog.begin(), catalog.end(), name) -
+                                                                 catalog.begin()));
+    }
+
+    template<size_t N>
+    inline void getPicks(const uint8_t *&in, CatalogPicks &picks, const std::array<std::string_view, N> &catalog) {
+        for (uint8_t count = get<uint8_t>(in); count > 0; count--) picks.push_back(catalog[get<uint8_t>(in)]);
+    }
+
+    /**
+     * Everything generated for a star, bit for bit, so reading it back gives the same system
+     */
+    inline void packSystem(std::vector<uint8_t> &out, const StarSystem &star) {
+        put<double>(out, star.starDiameter);
+        put<uint32_t>(out, star.starColor.n);
+        put<uint8_t>(out, uint8_t(star.planets.size()));
+        for (const auto &planet: star.planets) {
+            put<uint32_t>(out, planet.color.n);
+            put<double>(out, planet.distance);
+            put<double>(out, planet.diameter);
+            put<double>(out, planet.temperature);
+            put<double>(out, planet.population);
+            put<uint8_t>(out, uint8_t(planet.flora | planet.water << 1 | planet.ring << 2));
+            putPicks(out, planet.minerals, MINERALS);
+            putPicks(out, planet.gasses, GASSES);
+            put<uint8_t>(out, uint8_t(planet.moons.size()));
+            for (double moon: planet.moons) put<double>(out, moon);
+        }
+    }
+
+    inline void unpackSystem(const uint8_t *in, uint32_t x, uint32_t y, StarSystem &star) {
+        star.starExists = true;
+        star.starDiameter = get<double>(in);
+        star.starColor.n = get<uint32_t>(in);
+        star.planets.resize(get<uint8_t>(in));
+        for (size_t i = 0; i < star.planets.size(); i++) {
+            Planet &planet = star.planets[i];
+            planet.seed = planetSeed(x, y, int(i));
+            planet.color.n = get<uint32_t>(in);
+            planet.distance = get<double>(in);
+            planet.diameter = get<double>(in);
+            planet.temperature = get<double>(in);
+            planet.population = get<double>(in);
+            const uint8_t flags = get<uint8_t>(in);
+            planet.flora = flags & 1;
+            planet.water = flags & 2;
+            planet.ring = flags & 4;
+            getPicks(in, planet.minerals, MINERALS);
+            getPicks(in, planet.gasses, GASSES);
+            planet.moons.resize(get<uint8_t>(in));
+            for (double &moon: planet.moons) moon = get<double>(in);
+        }
+    }
+
+    /**
+     * The system whose record offset is at rank in an inflated band
+     */
+    inline std::shared_ptr<const StarSystem> unpackFromBand(const std::vector<uint8_t> &band, uint32_t rank,
+                                                            uint32_t x, uint32_t y) {
+        const uint8_t *offset = &band[rank * sizeof(uint32_t)];
+        auto star = std::make_shared<StarSystem>();
+        unpackSystem(band.data() + get<uint32_t>(offset), x, y, *star);
+        return star;
+    }
+
+    /**
+     * A tile as it goes into the file, bytes holding all of it from the bitmap on
+     */
+    struct EncodedTile {
+        std::vector<uint8_t> light, bands[BANDS], compressed, bytes;
+        uint32_t stars = 0;
+    };
+
+    inline void encodeTile(uint32_t tileX, uint32_t tileY, const GalaxyShape *shape, EncodedTile &tile) {
+        tile.bytes.assign(BITMAP_BYTES + TABLE_BYTES, 0);
+        tile.light.clear();
+        tile.stars = 0;
+
+        std::vector<uint32_t> offsets;
+        std::vector<uint8_t> records;
+        for (uint32_t band = 0; band < BANDS; band++) {
+            offsets.clear();
+            records.clear();
+            for (uint32_t j = band * BAND_ROWS; j < (band + 1) * BAND_ROWS; j++)
+                for (uint32_t i = 0; i < TILE_SIZE; i++) {
+                    const uint32_t x = tileX * TILE_SIZE + i, y = tileY * TILE_SIZE + j;
+                    const StarSystem star(x, y, true, shape ? shape->probability(x, y) : -1.0f);
+                    if (!star.starExists) continue;
+                    tile.bytes[(j * TILE_SIZE + i) / 8] |= uint8_t(1u << (i % 8));
+                    put<double>(tile.light, star.starDiameter);
+                    put<uint32_t>(tile.light, star.starColor.n);
+                    offsets.push_back(uint32_t(records.size()));
+                    packSystem(records, star);
+                }
+            tile.stars += uint32_t(offsets.size());
+
+            // The offsets go in front of the records, so are moved past themselves
+            std::vector<uint8_t> &packed = tile.bands[band];
+            packed.clear();
+            for (uint32_t offset: offsets) put<uint32_t>(packed, offset + uint32_t(offsets.size() * sizeof(uint32_t)));
+            packed.insert(packed.end(), records.begin(), records.end());
+        }
+
+        for (uint32_t block = 0; block <= BANDS; block++) {
+            const std::vector<uint8_t> &packed = block == 0 ? tile.light : tile.bands[block - 1];
+            uLongf compressedSize = compressBound(uLong(packed.size()));
+            tile.compressed.resize(compressedSize);
+            compress2(tile.compressed.data(), &compressedSize, packed.data(), uLong(packed.size()), Z_BEST_SPEED);
+
+            const uint32_t entry[3] = {uint32_t(tile.bytes.size()), uint32_t(compressedSize), uint32_t(packed.size())};
+            std::memcpy(&tile.bytes[BITMAP_BYTES + block * BLOCK_ENTRY_BYTES], entry, sizeof(entry));
+            tile.bytes.insert(tile.bytes.end(), tile.compressed.begin(), tile.compressed.begin() + compressedSize);
+        }
+    }
+
+    /**
+     * Generates tilesW by tilesH tiles from tile (tileX, tileY) into a new store at path. Tiles are
+     * generated and compressed on threads and written in order, a few per thread in memory at a time
+     */
+    inline bool buildTileStore(const std::string &path, const Header &header, unsigned threads) {
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open()) return false;
+
+        file.write("PUTILES1", 8);
+        const uint32_t fields[6] = {VERSION, header.tileX, header.tileY, header.tilesW, header.tilesH,
+                                    uint32_t(header.shaped)};
+        file.write((const char *) fields, sizeof(fields));
+
+        // The index is written last, once every tile's place is known
+        std::vector<IndexEntry> index(header.tiles());
+        const std::vector<char> placeholder(index.size() * INDEX_ENTRY_BYTES);
+        file.write(placeholder.data(), std::streamsize(placeholder.size()));
+
+        const std::unique_ptr<GalaxyShape> shape(header.shaped ? new GalaxyShape() : nullptr);
+        uint64_t next = 0;
+        produceInOrder<EncodedTile>(
+                header.tiles(), threads, size_t(threads) * 2,
+                [&](uint64_t tile, EncodedTile &encoded) {
+                    encodeTile(header.tileX + uint32_t(tile % header.tilesW),
+                               header.tileY + uint32_t(tile / header.tilesW), shape.get(), encoded);
+                },
+                [&](EncodedTile &encoded) {
+                    index[next++] = {uint64_t(file.tellp()), uint32_t(encoded.bytes.size()), encoded.stars};
+                    file.write((const char *) encoded.bytes.data(), std::streamsize(encoded.bytes.size()));
+                });
+
+        file.seekp(std::streamoff(HEADER_BYTES));
+        for (const auto &entry: index) {
+            const uint32_t rest[2] = {entry.bytes, entry.stars};
+            file.write((const char *) &entry.offset, sizeof(entry.offset));
+            file.write((const char *) rest, sizeof(rest));
+        }
+        file.close();
+        return !file.fail();
+    }
+
+    /**
+     * A tile read back for the galaxy view, whose stars are found by rank in the bitmap. Full systems are
+     * only there if asked for when it was read
+     */
+    class DecodedTile {
+    public:
+        uint32_t tileX = 0, tileY = 0;
+        std::vector<uint8_t> bitmap, light;
+        std::vector<uint8_t> bands[BANDS];
+
+        bool starExists(uint32_t i, uint32_t j) const {
+            const uint32_t bit = j * TILE_SIZE + i;
+            return bitmap[bit / 8] >> (bit % 8) & 1;
+        }
+
+        SectorInfo info(uint32_t i, uint32_t j) const {
+            SectorInfo info;
+            if (!starExists(i, j)) return info;
+            const uint8_t *record = light.data() + rank(j * TILE_SIZE + i) * LIGHT_RECORD_BYTES;
+            info.starExists = true;
+            info.starDiameter = get<double>(record);
+            info.starColor.n = get<uint32_t>(record);
+            return info;
+        }
+
+        std::shared_ptr<const StarSystem> system(uint32_t i, uint32_t j) const {
+            if (!starExists(i, j)) return nullptr;
+            const uint32_t band = j / BAND_ROWS;
+            return unpackFromBand(bands[band], rank(j * TILE_SIZE + i) - ranks[band * BAND_ROWS * TILE_SIZE / 64],
+                                  tileX * TILE_SIZE + i, tileY * TILE_SIZE + j);
+        }
+
+        // Counts the stars ahead of each 64-bit word of the bitmap, so finding a record takes one popcount
+        void buildRanks() {
+            ranks.resize(BITMAP_BYTES / 8);
+            uint32_t stars = 0;
+            for (size_t w = 0; w < ranks.size(); w++) {
+                ranks[w] = stars;
+                stars += uint32_t(std::bitset<64>(word(w)).count());
+            }
+        }
+
+    private:
+        uint64_t word(size_t w) const {
+            uint64_t value;
+            std::memcpy(&value, &bitmap[w * 8], sizeof(value));
+            return value;
+        }
+
+        uint32_t rank(uint32_t bit) const {
+            const uint64_t before = word(bit / 64) & ((uint64_t(1) << (bit % 64)) - 1);
+            return ranks[bit / 64] + uint32_t(std::bitset<64>(before).count());
+        }
+
+        std::vector<uint32_t> ranks;
+    };
+
+    /**
+     * A tile store opened for reading, safe to share between threads
+     */
+    class TileStore {
+    public:
+        bool open(const std::string &path) {
+            file.open(path, std::ios::binary);
+            char magic[8];
+            uint32_t fields[6];
+            if (!file.read(magic, 8) || std::memcmp(magic, "PUTILES1", 8) != 0) return false;
+            if (!file.read((char *) fields, sizeof(fields)) || fields[0] != VERSION) return false;
+            header = {fields[1], fields[2], fields[3], fields[4], fields[5] != 0};
+            return true;
+        }
+
+        const Header &getHeader() const { return header; }
+
+        /**
+         * The index of the tile holding sector (x, y), or -1 if the store does not cover it
+         */
+        int64_t tileOf(uint32_t x, uint32_t y) const {
+            const uint32_t tx = (x >> TILE_BITS) - header.tileX, ty = (y >> TILE_BITS) - header.tileY;
+            if (tx >= header.tilesW || ty >= header.tilesH) return -1;
+            return int64_t(ty) * header.tilesW + tx;
+        }
+
+        /**
+         * Whether every sector of rect is in the store
+         */
+        bool covers(const SectorRect &rect) const {
+            if (rect.w == 0 || rect.h == 0 || rect.x + (rect.w - 1) < rect.x || rect.y + (rect.h - 1) < rect.y)
+                return false;
+            return tileOf(rect.x, rect.y) >= 0 && tileOf(rect.x + rect.w - 1, rect.y + rect.h - 1) >= 0;
+        }
+
+        /**
+         * Whether sector (x, y) holds a star, one byte read from the bitmap and nothing inflated
+         */
+        bool starExists(uint32_t x, uint32_t y) {
+            const int64_t tile = tileOf(x, y);
+            if (tile < 0) return false;
+            const uint32_t bit = (y % TILE_SIZE) * TILE_SIZE + x % TILE_SIZE;
+            const IndexEntry entry = readEntry(uint64_t(tile));
+            uint8_t byte = 0;
+            return entry.offset != 0 && read(entry.offset + bit / 8, &byte, 1) && (byte >> (bit % 8) & 1);
+        }
+
+        /**
+         * Reads a tile's bitmap and its stars' sizes and colours, and full systems too if systems is set
+         */
+        bool readTile(uint64_t tile, DecodedTile &decoded, bool systems = false) {
+            const IndexEntry entry = readEntry(tile);
+            if (entry.offset == 0) return false;
+            decoded.tileX = header.tileX + uint32_t(tile % header.tilesW);
+            decoded.tileY = header.tileY + uint32_t(tile / header.tilesW);
+            decoded.bitmap.resize(BITMAP_BYTES);
+            if (!read(entry.offset, decoded.bitmap.data(), BITMAP_BYTES) ||
+                !readBlock(entry.offset, 0, decoded.light) || decoded.light.size() != entry.stars * LIGHT_RECORD_BYTES)
+                return false;
+            for (uint32_t band = 0; band < BANDS; band++) {
+                if (!systems) decoded.bands[band].clear();
+                else if (!readBlock(entry.offset, 1 + band, decoded.bands[band])) return false;
+            }
+            decoded.buildRanks();
+            return true;
+        }
+
+        /**
+         * The full system in sector (x, y), inflating only its band of the tile. nullptr if the sector is
+         * empty or outside the store
+         */
+        std::shared_ptr<const StarSystem> readSystem(uint32_t x, uint32_t y) {
+            const int64_t tile = tileOf(x, y);
+            if (tile < 0) return nullptr;
+            const IndexEntry entry = readEntry(uint64_t(tile));
+            const uint32_t band = y % TILE_SIZE / BAND_ROWS;
+            uint8_t bitmap[BAND_BITMAP_BYTES];
+            if (entry.offset == 0 || !read(entry.offset + band * BAND_BITMAP_BYTES, bitmap, sizeof(bitmap)))
+                return nullptr;
+
+            // The stars ahead of this one in its band give its record's rank
+            const uint32_t bit = (y % BAND_ROWS) * TILE_SIZE + x % TILE_SIZE;
+            if (!(bitmap[bit / 8] >> (bit % 8) & 1)) return nullptr;
+            uint32_t rank = uint32_t(std::bitset<8>(bitmap[bit / 8] & ((1u << (bit % 8)) - 1)).count());
+            for (uint32_t i = 0; i < bit / 8; i++) rank += uint32_t(std::bitset<8>(bitmap[i]).count());
+
+            std::vector<uint8_t> packed;
+            if (!readBlock(entry.offset, 1 + band, packed)) return nullptr;
+            return unpackFromBand(packed, rank, x, y);
+        }
+
+    private:
+        IndexEntry readEntry(uint64_t tile) {
+            uint8_t bytes[INDEX_ENTRY_BYTES];
+            IndexEntry entry;
+            if (!read(HEADER_BYTES + tile * INDEX_ENTRY_BYTES, bytes, sizeof(bytes))) return entry;
+            const uint8_t *in = bytes;
+            entry.offset = get<uint64_t>(in);
+            entry.bytes = get<uint32_t>(in);
+            entry.stars = get<uint32_t>(in);
+            return entry;
+        }
+
+        bool readBlock(uint64_t tileOffset, uint32_t block, std::vector<uint8_t> &packed) {
+            uint8_t bytes[BLOCK_ENTRY_BYTES];
+            if (!read(tileOffset + BITMAP_BYTES + block * BLOCK_ENTRY_BYTES, bytes, sizeof(bytes))) return false;
+            const uint8_t *in = bytes;
+            BlockEntry entry;
+            entry.offset = get<uint32_t>(in);
+            entry.compressedSize = get<uint32_t>(in);
+            entry.packedSize = get<uint32_t>(in);
+
+            std::vector<uint8_t> compressed(entry.compressedSize);
+            if (!read(tileOffset + entry.offset, compressed.data(), compressed.size())) return false;
+            packed.resize(entry.packedSize);
+            uLongf packedSize = entry.packedSize;
+            return uncompress(packed.data(), &packedSize, compressed.data(), uLong(compressed.size())) == Z_OK &&
+                   packedSize == entry.packedSize;
+        }
+
+        bool read(uint64_t offset, void *out, size_t size) {
+            std::lock_guard<std::mutex> lock(mutex);
+            file.clear();
+            file.seekg(std::streamoff(offset));
+            return bool(file.read((char *) out, std::streamsize(size)));
+        }
+
+        std::ifstream file;
+        std::mutex mutex;
+        Header header;
+    };
+
+    /**
+     * Pages tiles of a store in on a background thread for the galaxy view, keeping the most recently used
+     * ones decoded
+     */
+    class TilePager {
+    public:
+        TilePager(TileStore &store, size_t capacity = 16)
+                : store(store), capacity(capacity), thread(&TilePager::run, this) {}
+
+        ~TilePager() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                quit = true;
+            }
+            wake.notify_one();
+            thread.join();
+        }
+
+        TilePager(const TilePager &) = delete;
+
+        /**
+         * The tile if it is resident, otherwise it is queued to be read and nullptr comes back, unless
+         * wait is set, in which case this returns once it has been read
+         */
+        std::shared_ptr<const DecodedTile> find(uint64_t tile, bool wait = false) {
+            std::unique_lock<std::mutex> lock(mutex);
+            auto found = resident.find(tile);
+            if (found == resident.end()) {
+                if (std::find(queue.begin(), queue.end(), tile) == queue.end()) {
+                    queue.push_back(tile);
+                    wake.notify_one();
+                }
+                if (!wait) return nullptr;
+                loaded.wait(lock, [&]() { return (found = resident.find(tile)) != resident.end(); });
+            }
+            recent.splice(recent.begin(), recent, found->second.second);
+            return found->second.first;
+        }
+
+    private:
+        void run() {
+            for (;;) {
+                uint64_t tile;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wake.wait(lock, [&]() { return quit || !queue.empty(); });
+                    if (quit) return;
+                    tile = queue.front();
+                }
+
+                // A tile that fails to read is left empty, the view shows no stars in it
+                auto decoded = std::make_shared<DecodedTile>();
+                if (!store.readTile(tile, *decoded)) {
+                    decoded->bitmap.assign(BITMAP_BYTES, 0);
+                    decoded->buildRanks();
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    queue.pop_front();
+                    recent.push_front(tile);
+                    resident[tile] = {std::move(decoded), recent.begin()};
+                    while (resident.size() > capacity) {
+                        resident.erase(recent.back());
+                        recent.pop_back();
+                    }
+                }
+                loaded.notify_all();
+            }
+        }
+
+        TileStore &store;
+        const size_t capacity;
+        std::mutex mutex;
+        std::condition_variable wake, loaded;
+        std::deque<uint64_t> queue;
+        std::list<uint64_t> recent;
+        std::unordered_map<uint64_t, std::pair<std::shared_ptr<const DecodedTile>, std::list<uint64_t>::iterator>>
+                resident;
+        bool quit = false;
+        std::thread thread;
+    };
+}
@@ -0,0 +1,386 @@
+#define OLC_PGE_APPLICATION
+
+#include "olcPixelGameEngine.h"
+#include "StarSystem.h"
+#include "Galaxy.h"
+#include "PlanetTexture.h"
+#include "Orbits.h"
+#include "GalaxyShape.h"
+#include "TileStore.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+#if !defined(OLC_ALLOC_STATS)
+#error "The benchmarks report allocations, build them with OLC_ALLOC_STATS"
+#endif
+
+/**
+ * Keeps a result alive so the optimiser cannot drop the work that produced it
+ */
+template<typename T>
+static void keep(const T &value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static const void *volatile sink;
+    sink = &value;
+#endif
+}
+
+struct BenchOptions {
+    std::string filter;
+    double minSeconds = 0.25;
+};
+
+static bool selected(const BenchOptions &options, const std::string &name) {
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+/**
+ * Whether any of a group's benchmarks will run, so setup the filter leaves unused can be skipped
+ */
+static bool anySelected(const BenchOptions &options, std::initializer_list<const char *> names) {
+    for (const char *name: names)
+        if (selected(options, name)) return true;
+    return false;
+}
+
+/**
+ * Runs op in growing batches until one batch lasts minSeconds, then reports that batch per operation
+ */
+template<typename Op>
+static void runBench(const BenchOptions &options, const std::string &name, double itemsPerOp, Op op) {
+    if (!selected(options, name)) return;
+
+    op(); // Warm up caches and any lazily grown buffers
+    uint64_t iterations = 1;
+    for (;;) {
+        const olc::AllocStats allocationsBefore = olc::GetAllocStats();
+        const auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) op();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const olc::AllocStats allocationsAfter = olc::GetAllocStats();
+        const uint64_t allocations = allocationsAfter.nAllocations - allocationsBefore.nAllocations;
+        const uint64_t bytes = allocationsAfter.nBytes - allocationsBefore.nBytes;
+
+        if (seconds >= options.minSeconds || iterations >= (1ull << 40)) {
+            const double nsPerOp = seconds * 1e9 / double(iterations);
+            std::printf("%-36s %12llu %14.1f %14.4g %12.2f %12.1f\n", name.c_str(), (unsigned long long) iterations,
+                        nsPerOp, itemsPerOp * double(iterations) / seconds, double(allocations) / double(iterations),
+                        double(bytes) / double(iterations));
+            return;
+        }
+
+        // Aim straight for the target time, with some headroom, rather than doubling all the way there
+        const double scale = seconds > 0.0 ? options.minSeconds / seconds * 1.2 : 10.0;
+        iterations = std::max(iterations * 2, uint64_t(double(iterations) * std::min(scale, 100.0)));
+    }
+}
+
+static void benchGenerator(const BenchOptions &options) {
+    LehmerGenerator generator(0x12345678);
+    runBench(options, "lehmer/Lehmer32", 1, [&]() { keep(generator.Lehmer32()); });
+    runBench(options, "lehmer/rndInt", 1, [&]() { keep(generator.rndInt(-273, 300)); });
+    runBench(options, "lehmer/rndDouble", 1, [&]() { keep(generator.rndDouble(1.0, 5.0)); });
+
+    uint32_t sector = 0;
+    runBench(options, "starsystem/light", 1, [&]() {
+        StarSystem star(sector & 0xFFF, sector >> 12);
+        keep(star.starExists);
+        sector++;
+    });
+    runBench(options, "starsystem/full", 1, [&]() {
+        StarSystem star(sector & 0xFFF, sector >> 12, true);
+        keep(star.planets.size());
+        sector++;
+    });
+
+    // Only sectors holding a star generate planets, time those on their own
+    std::vector<olc::vi2d> stars;
+    for (uint32_t y = 0; stars.size() < 4096; y++)
+        for (uint32_t x = 0; x < 256; x++)
+            if (StarSystem(x, y).starExists) stars.push_back({int32_t(x), int32_t(y)});
+    size_t nextStar = 0;
+    runBench(options, "starsystem/full_with_star", 1, [&]() {
+        const olc::vi2d &position = stars[nextStar++ % stars.size()];
+        StarSystem star(position.x, position.y, true);
+        keep(star.planets.size());
+    });
+}
+
+static void benchSectorGrid(const BenchOptions &options) {
+    const olc::vi2d windows[] = {{256, 240}, {512, 512}, {1280, 720}, {1920, 1080}};
+    for (const auto &window: windows) {
+        const int sectorsX = window.x / 16, sectorsY = window.y / 16;
+        uint32_t offset = 0;
+        runBench(options, "grid/" + std::to_string(window.x) + "x" + std::to_string(window.y),
+                 sectorsX * sectorsY, [&]() {
+                    int count = 0;
+                    for (int x = 0; x < sectorsX; x++)
+                        for (int y = 0; y < sectorsY; y++)
+                            count += StarSystem(x + offset, y + offset).starExists;
+                    keep(count);
+                    offset += 7;
+                });
+    }
+}
+
+static void benchGalaxyShape(const BenchOptions &options) {
+    // The existence test alone, flat and shaped, over a screen of sectors near the core
+    const GalaxyShape shape;
+    const int sectorsX = 32, sectorsY = 32;
+    std::vector<float> probabilities(sectorsX);
+    uint32_t offset = 0;
+    runBench(options, "shape/existence_flat", sectorsX * sectorsY, [&]() {
+        int count = 0;
+        for (int y = 0; y < sectorsY; y++)
+            for (int x = 0; x < sectorsX; x++) count += StarSystem(x + offset, y + offset).starExists;
+        keep(count);
+        offset += 7;
+    });
+    runBench(options, "shape/existence_shaped", sectorsX * sectorsY, [&]() {
+        int count = 0;
+        for (int y = 0; y < sectorsY; y++) {
+            shape.probabilityRow(offset, y + offset, sectorsX, probabilities.data());
+            for (int x = 0; x < sectorsX; x++)
+                count += StarSystem(x + offset, y + offset, false, probabilities[x]).starExists;
+        }
+        keep(count);
+        offset += 7;
+    });
+    runBench(options, "shape/probability", 1, [&]() { keep(shape.probability(offset++, 100)); });
+    runBench(options, "shape/probability_row_32", sectorsX, [&]() {
+        shape.probabilityRow(offset++, 100, sectorsX, probabilities.data());
+        keep(probabilities[0]);
+    });
+}
+
+static void benchRaster(const BenchOptions &options) {
+    // Drawing into an offscreen sprite needs no window, only the font sheet for text
+    Galaxy galaxy;
+    galaxy.Construct(512, 512, 1, 1);
+    galaxy.olc_ConstructFontSheet();
+    olc::Sprite target(512, 512);
+    galaxy.SetDrawTarget(&target);
+
+    olc::Sprite sprite(64, 64);
+    for (int y = 0; y < 64; y++)
+        for (int x = 0; x < 64; x++)
+            sprite.SetPixel(x, y, olc::Pixel(x * 4, y * 4, 128, (x + y) * 2));
+
+    runBench(options, "raster/Clear_512x512", 512 * 512, [&]() { galaxy.Clear(olc::BLACK); });
+    runBench(options, "raster/FillRect_64x64", 64 * 64, [&]() { galaxy.FillRect(100, 100, 64, 64, olc::RED); });
+    runBench(options, "raster/FillCircle_r8", 1, [&]() { galaxy.FillCircle(200, 200, 8, olc::YELLOW); });
+    runBench(options, "raster/FillCircle_r64", 1, [&]() { galaxy.FillCircle(200, 200, 64, olc::YELLOW); });
+    runBench(options, "raster/DrawString_32", 32, [&]() {
+        galaxy.DrawString(10, 10, "Distance from sun: 291.308 u  ok", olc::WHITE);
+    });
+    runBench(options, "raster/DrawSprite_64x64", 64 * 64, [&]() { galaxy.DrawSprite(50, 50, &sprite); });
+    galaxy.SetPixelMode(olc::Pixel::ALPHA);
+    runBench(options, "raster/DrawSprite_64x64_alpha", 64 * 64, [&]() { galaxy.DrawSprite(50, 50, &sprite); });
+    galaxy.SetPixelMode(olc::Pixel::NORMAL);
+
+    // The planet window text, formatting and all
+    StarSystem star(0, 0);
+    uint32_t y = 0;
+    do star = StarSystem(7, y++, true); while (star.planets.empty());
+    runBench(options, "text/printPlanetInfo", 1, [&]() { galaxy.printPlanetInfo(star.planets[0], 18, 100); });
+}
+
+/**
+ * How the planet info was formatted before FixedText, kept to compare against
+ */
+static std::string formatPlanetInfoStream(const Planet &planet) {
+    std::stringstream stream;
+    stream << "Distance from sun: " << planet.distance << " u" << "\nDiameter: " << planet.diameter << " u"
+           << "\nFlora: " << (planet.flora ? "Yes" : "No") << "\nMinerals: ";
+    if (planet.minerals.empty()) stream << "None";
+    else for (const auto &mineral: planet.minerals) stream << mineral << " ";
+    stream << "\nWater: " << (planet.water ? "Yes" : "No") << "\nGasses: ";
+    if (planet.gasses.empty()) stream << "None";
+    else for (const auto &gas: planet.gasses) stream << gas << " ";
+    stream << "\nTemperature: " << planet.temperature << " C"
+           << "\nPopulation: " << planet.population
+           << "\nRing: " << (planet.ring ? "Yes" : "No");
+    return stream.str();
+}
+
+/**
+ * False if the fixed buffer text differs from the stringstream text for any planet
+ */
+static bool benchFormatting(const BenchOptions &options) {
+    std::vector<Planet> planets;
+    for (uint32_t y = 0; planets.size() < 4096; y++) {
+        StarSystem star(3, y, true);
+        planets.insert(planets.end(), star.planets.begin(), star.planets.end());
+    }
+
+    // Both must give the same text before their speed means anything
+    size_t mismatches = 0;
+    for (const auto &planet: planets) {
+        Galaxy::PlanetInfoText text;
+        Galaxy::formatPlanetInfo(planet, text);
+        mismatches += text.view() != formatPlanetInfoStream(planet);
+    }
+    if (mismatches != 0) {
+        std::fprintf(stderr, "format/planet_info: %zu of %zu planets differ from the stringstream text\n",
+                     mismatches, planets.size());
+        return false;
+    }
+    if (!selected(options, "format/planet_info")) return true;
+
+    size_t next = 0;
+    runBench(options, "format/planet_info_stringstream", 1, [&]() {
+        keep(formatPlanetInfoStream(planets[next++ % planets.size()]));
+    });
+    runBench(options, "format/planet_info_fixed", 1, [&]() {
+        Galaxy::PlanetInfoText text;
+        Galaxy::formatPlanetInfo(planets[next++ % planets.size()], text);
+        keep(text);
+    });
+    return true;
+}
+
+static void benchTextures(const BenchOptions &options) {
+    std::vector<float> heights(64);
+    runBench(options, "texture/noise_row_64_scalar", 64, [&]() {
+        surfaceNoiseRowScalar(heights.data(), 0, 64, 0.0f, 0.1f, 1.5f, 1234, 4);
+        keep(heights[0]);
+    });
+    runBench(options, "texture/noise_row_64", 64, [&]() {
+        surfaceNoiseRow(heights.data(), 64, 0.0f, 0.1f, 1.5f, 1234, 4);
+        keep(heights[0]);
+    });
+
+    // A whole system's worth of planets, as the system window draws them
+    StarSystem star(0, 0);
+    uint32_t y = 0;
+    do star = StarSystem(11, y++, true); while (star.planets.size() < 9);
+    runBench(options, "texture/system_9_planets", star.planets.size(), [&]() {
+        olc::SpriteCache cache;
+        for (const auto &planet: star.planets) keep(getPlanetSurface(cache, planet, (int) planet.diameter));
+    });
+
+    // Revisiting under a budget too small to hold everything, most lookups go to a few hot surfaces
+    olc::SpriteCache cache(256 * 1024);
+    LehmerGenerator picks(42);
+    runBench(options, "texture/cache_revisit", 1, [&]() {
+        const uint32_t pick = picks.Lehmer32();
+        const uint32_t surface = (pick >> 16) % 5 != 0 ? pick % 8 : pick % 200;
+        const Planet &planet = star.planets[surface % star.planets.size()];
+        keep(getPlanetSurface(cache, planet, 5 + int(surface / star.planets.size())));
+        cache.NextFrame();
+    });
+    if (selected(options, "texture/cache_revisit"))
+        std::printf("%-36s hit rate %.2f, %zu entries, %zu bytes resident\n", "texture/cache_revisit", cache.GetHitRate(),
+                cache.GetEntryCount(), cache.GetResidentBytes());
+}
+
+static void benchOrbits(const BenchOptions &options) {
+    double t = 0.0;
+    if (anySelected(options, {"orbits/update_1M", "orbits/update_1M_scalar"})) {
+        // A million bodies on orbits like the generator's, the target for one frame on one core
+        OrbitBodies bodies;
+        LehmerGenerator generator(0xB0D1E5);
+        for (int i = 0; i < 1000000; i++)
+            bodies.add(float(generator.rndDouble(60.0, 2000.0)), float(generator.rndDouble(0.0, 0.15)),
+                       float(generator.rndDouble(0.0, ORBIT_TWO_PI)), float(generator.rndDouble(0.0, ORBIT_TWO_PI)),
+                       400.0f);
+        runBench(options, "orbits/update_1M", double(bodies.size()), [&]() {
+            bodies.update(t += 1.0 / 60.0);
+            keep(bodies.x[0]);
+        });
+        runBench(options, "orbits/update_1M_scalar", double(bodies.size()), [&]() {
+            bodies.updateScalar(t += 1.0 / 60.0, 0);
+            keep(bodies.x[0]);
+        });
+    }
+
+    // Every planet and moon of a system with all nine planets
+    if (!selected(options, "orbits/system")) return;
+    StarSystem star(0, 0);
+    uint32_t y = 0;
+    do star = StarSystem(11, y++, true); while (star.planets.size() < 9);
+    OrbitBodies planets, moons;
+    addSystemOrbits(planets, moons, star);
+    runBench(options, "orbits/system", double(planets.size() + moons.size()), [&]() {
+        planets.update(t += 1.0 / 60.0);
+        moons.update(t);
+        keep(planets.x[0]);
+    });
+}
+
+static void benchTileStore(const BenchOptions &options) {
+    if (!anySelected(options, {"tiles/generate_tile", "tiles/read_tile", "tiles/read_tile_systems",
+                               "tiles/exists_on_disk", "tiles/system_generate", "tiles/system_unpack",
+                               "tiles/system_read"}))
+        return;
+
+    // One tile, read back against generating its sectors. The pid keeps runs side by side apart
+    const std::string name = "bench." + std::to_string(getpid()) + ".tiles";
+    const std::string path = (std::filesystem::temp_directory_path() / name).string();
+    tiles::Header header;
+    header.tilesW = header.tilesH = 1;
+    if (!tiles::buildTileStore(path, header, 1)) return;
+    tiles::TileStore store;
+    store.open(path);
+
+    const uint32_t sectors = tiles::TILE_SIZE * tiles::TILE_SIZE;
+    runBench(options, "tiles/generate_tile", sectors, [&]() {
+        int count = 0;
+        for (uint32_t y = 0; y < tiles::TILE_SIZE; y++)
+            for (uint32_t x = 0; x < tiles::TILE_SIZE; x++) count += StarSystem(x, y).starExists;
+        keep(count);
+    });
+    tiles::DecodedTile tile;
+    runBench(options, "tiles/read_tile", sectors, [&]() { keep(store.readTile(0, tile)); });
+    runBench(options, "tiles/read_tile_systems", sectors, [&]() { keep(store.readTile(0, tile, true)); });
+    uint32_t offset = 0;
+    runBench(options, "tiles/exists_on_disk", 1, [&]() {
+        offset += 7;
+        keep(store.starExists(offset % tiles::TILE_SIZE, offset / tiles::TILE_SIZE % tiles::TILE_SIZE));
+    });
+
+    // A full system, unpacked against generated. The tile is read here as the benchmarks above may
+    // have been filtered out
+    if (!store.readTile(0, tile, true)) {
+        std::filesystem::remove(path);
+        return;
+    }
+    uint32_t x = 0;
+    while (!tile.starExists(x, 5)) x++;
+    runBench(options, "tiles/system_generate", 1, [&]() { keep(StarSystem(x, 5, true).planets.size()); });
+    runBench(options, "tiles/system_unpack", 1, [&]() { keep(tile.system(x, 5)->planets.size()); });
+    runBench(options, "tiles/system_read", 1, [&]() { keep(store.readSystem(x, 5)->planets.size()); });
+    std::filesystem::remove(path);
+}
+
+int main(int argc, char *argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--time" && i + 1 < argc) options.minSeconds = std::stod(argv[++i]);
+        else if (arg[0] != '-' && options.filter.empty()) options.filter = arg;
+        else {
+            std::cerr << "Usage: " << argv[0] << " [filter] [--time seconds]\n";
+            return 1;
+        }
+    }
+
+    std::printf("%-36s %12s %14s %14s %12s %12s\n", "benchmark", "iterations", "ns/op", "items/s", "allocs/op",
+                "bytes/op");
+    benchGenerator(options);
+    benchSectorGrid(options);
+    benchGalaxyShape(options);
+    benchRaster(options);
+    const bool formattingMatches = benchFormatting(options);
+    benchTextures(options);
+    benchOrbits(options);
+    benchTileStore(options);
+    return formattingMatches ? 0 : 1;
+}
@@ -345,7 +345,9 @@ int main()
 // O------------------------------------------------------------------------------O
 #include <cmath>
 #include <cstdint>
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <streambuf>
 #include <sstream>
@@ -354,12 +356,19 @@ int main()
 #include <list>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <fstream>
 #include <map>
+#include <unordered_map>
 #include <functional>
 #include <algorithm>
 #include <array>
 #include <cstring>
+#include <iomanip>
+#include <memory>
+#include <new>
+#include <cstdlib>
 #pragma endregion
 
 #define PGE_VER 217
@@ -405,7 +414,7 @@ int main()
 // O------------------------------------------------------------------------------O
 
 // Platform
-#if !defined(OLC_PLATFORM_WINAPI) && !defined(OLC_PLATFORM_X11) && !defined(OLC_PLATFORM_GLUT) && !defined(OLC_PLATFORM_EMSCRIPTEN)
+#if !defined(OLC_PLATFORM_WINAPI) && !defined(OLC_PLATFORM_X11) && !defined(OLC_PLATFORM_GLUT) && !defined(OLC_PLATFORM_EMSCRIPTEN) && !defined(OLC_PLATFORM_HEADLESS)
 	#if !defined(OLC_PLATFORM_CUSTOM_EX)
 		#if defined(_WIN32)
 			#define OLC_PLATFORM_WINAPI
@@ -429,9 +438,11 @@ int main()
 #endif
 
 // Renderer
-#if !defined(OLC_GFX_OPENGL10) && !defined(OLC_GFX_OPENGL33) && !defined(OLC_GFX_DIRECTX10)
+#if !defined(OLC_GFX_OPENGL10) && !defined(OLC_GFX_OPENGL33) && !defined(OLC_GFX_DIRECTX10) && !defined(OLC_GFX_NULL)
 	#if !defined(OLC_GFX_CUSTOM_EX)
-		#if defined(OLC_PLATFORM_EMSCRIPTEN)
+		#if defined(OLC_PLATFORM_HEADLESS)
+			#define OLC_GFX_NULL
+		#elif defined(OLC_PLATFORM_EMSCRIPTEN)
 			#define OLC_GFX_OPENGL33
 		#else
 			#define OLC_GFX_OPENGL10
@@ -514,6 +525,7 @@ namespace olc
 	constexpr uint8_t  nDefaultAlpha = 0xFF;
 	constexpr uint32_t nDefaultPixel = (nDefaultAlpha << 24);
 	constexpr uint8_t  nTabSizeInSpaces = 4;
+	constexpr uint32_t nFrameHistory = 1024;
 	enum rcode { FAIL = 0, OK = 1, NO_FILE = -1 };
 
 	// O------------------------------------------------------------------------------O
@@ -821,10 +833,12 @@ namespace olc
 	struct DecalInstance
 	{
 		olc::Decal* decal = nullptr;
-		std::vector<olc::vf2d> pos;
-		std::vector<olc::vf2d> uv;
-		std::vector<float> w;
-		std::vector<olc::Pixel> tint;
+		// Per vertex geometry, 'points' of each, held in the engine's frame arena
+		// and only valid until the frame is presented
+		olc::vf2d* pos = nullptr;
+		olc::vf2d* uv = nullptr;
+		float* w = nullptr;
+		olc::Pixel* tint = nullptr;
 		olc::DecalMode mode = olc::DecalMode::NORMAL;
 		olc::DecalStructure structure = olc::DecalStructure::FAN;
 		uint32_t points = 0;
@@ -843,6 +857,24 @@ namespace olc
 		std::function<void()> funcHook = nullptr;
 	};
 
+	struct DrawCommand
+	{
+		enum class Type : uint8_t { CLEAR, FILL_RECT, FILL_CIRCLE, DRAW_STRING, DRAW_SPRITE };
+		Type type = Type::CLEAR;
+		olc::Pixel::Mode nMode = olc::Pixel::NORMAL;
+		float fBlend = 1.0f;
+		olc::Pixel col = olc::WHITE;
+		olc::vi2d vPos;				// Position as passed to the drawing routine
+		olc::vi2d vSize;			// Rectangle or sprite area size, or { radius, 0 } for circles
+		olc::vi2d vSource;			// Top left of the sprite area
+		uint32_t nScale = 1;
+		uint8_t nFlip = 0;
+		olc::Sprite* pSprite = nullptr;
+		uint32_t nTextOffset = 0;	// Text lives in one buffer shared by the whole list
+		uint32_t nTextLength = 0;
+		olc::vi2d vMin, vMax;		// Area that may be touched, max exclusive
+	};
+
 	class Renderer
 	{
 	public:
@@ -855,6 +887,8 @@ namespace olc
 		virtual void	   SetDecalMode(const olc::DecalMode& mode) = 0;
 		virtual void       DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) = 0;
 		virtual void       DrawDecal(const olc::DecalInstance& decal) = 0;
+		// Draws a layer's decals in order, renderers that can batch them override this
+		virtual void       DrawDecals(const std::vector<olc::DecalInstance>& decals) { for (const auto& decal : decals) DrawDecal(decal); }
 		virtual uint32_t   CreateTexture(const uint32_t width, const uint32_t height, const bool filtered = false, const bool clamp = true) = 0;
 		virtual void       UpdateTexture(uint32_t id, olc::Sprite* spr) = 0;
 		virtual void       ReadTexture(uint32_t id, olc::Sprite* spr) = 0;
@@ -863,6 +897,10 @@ namespace olc
 		virtual void       UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) = 0;
 		virtual void       ClearBuffer(olc::Pixel p, bool bDepth) = 0;
 		static olc::PixelGameEngine* ptrPGE;
+
+		// Work submitted this frame, reset by the engine before drawing starts
+		uint32_t nDrawCalls = 0;
+		uint32_t nVertices = 0;
 	};
 
 	class Platform
@@ -881,6 +919,312 @@ namespace olc
 		static olc::PixelGameEngine* ptrPGE;
 	};
 
+#if defined(OLC_PLATFORM_HEADLESS)
+	// O------------------------------------------------------------------------------O
+	// | olc::HeadlessConfig - Drives the offscreen platform, no window or GPU needed |
+	// O------------------------------------------------------------------------------O
+	struct HeadlessEvent
+	{
+		enum class Type { KEY, MOUSE_MOVE, MOUSE_BUTTON, MOUSE_WHEEL, QUIT };
+		uint32_t nFrame = 0;		// Frame at the start of which the event is delivered
+		Type type = Type::KEY;
+		int32_t nCode = 0;			// olc::Key, mouse button, or wheel delta
+		bool bState = false;		// Pressed (true) or released (false)
+		olc::vi2d vPos = { 0, 0 };	// Mouse position in window space
+	};
+
+	struct HeadlessConfig
+	{
+		// Number of frames to run before terminating, 0 = until told to quit
+		uint32_t nMaxFrames = 0;
+		// Where to dump presented frames, "#" characters are replaced by the zero
+		// padded frame number, a ".raw" extension writes raw RGBA, anything else
+		// PNG. Empty = don't dump
+		std::string sFramePath;
+		// Dump every n-th presented frame
+		uint32_t nDumpInterval = 1;
+		// Input delivered to the engine, in frame order
+		std::vector<HeadlessEvent> vScript;
+
+		// Reads a text input script, one event per line:
+		//   <frame> key <NAME> down|up    e.g. "10 key W down"
+		//   <frame> mouse <x> <y>         window coordinates
+		//   <frame> button <n> down|up
+		//   <frame> wheel <delta>
+		//   <frame> quit
+		// Blank lines and lines starting with '#' are ignored
+		olc::rcode LoadScript(const std::string& sFile);
+	};
+#endif
+
+	// O------------------------------------------------------------------------------O
+	// | olc::FrameStats - Where the time goes in each frame, in milliseconds         |
+	// O------------------------------------------------------------------------------O
+	struct FrameTiming
+	{
+		uint32_t nFrame = 0;
+		float fInput = 0.0f;	// System events and input scan
+		float fUpdate = 0.0f;	// OnUserUpdate, extensions and command list flush
+		float fUpload = 0.0f;	// Layer texture uploads
+		float fDecals = 0.0f;	// Layer quads and decal submission
+		float fPresent = 0.0f;	// DisplayFrame
+		float fFrame = 0.0f;	// This frame's phases together, any wait before the next is not counted
+		uint32_t nDrawCalls = 0;	// As counted by the renderer
+		uint32_t nVertices = 0;
+		uint32_t nAllocations = 0;	// Heap allocations on any thread, only counted with OLC_ALLOC_STATS
+		uint64_t nAllocBytes = 0;
+	};
+
+	struct FrameStats
+	{
+		// Number of frames the percentiles were taken over, at most nFrameHistory
+		uint32_t nSamples = 0;
+		// Each phase ranked on its own, so the fields need not add up
+		FrameTiming p50, p95, p99;
+	};
+
+	// O------------------------------------------------------------------------------O
+	// | olc::AllocStats - Heap traffic, counted when built with OLC_ALLOC_STATS      |
+	// O------------------------------------------------------------------------------O
+	// Defining OLC_ALLOC_STATS where OLC_PGE_APPLICATION is defined replaces the global
+	// operator new and delete with counting versions. Without it every count reads zero
+	// and OLC_ALLOC_SCOPE compiles to nothing
+	struct AllocStats
+	{
+		uint64_t nAllocations = 0;
+		uint64_t nBytes = 0;
+		uint64_t nFrees = 0;
+	};
+
+	// Totals since start up, across all threads
+	AllocStats GetAllocStats();
+	// Totals since start up, for the calling thread
+	AllocStats GetThreadAllocStats();
+
+	struct AllocScopeStats
+	{
+		const char* sName = nullptr;
+		uint32_t nEntries = 0;		// Times the scope was entered
+		AllocStats stats;
+	};
+
+	// Counts what the calling thread allocates between construction and destruction,
+	// adding it to a running total kept under sName, which must be a string literal
+	class AllocScope
+	{
+	public:
+		explicit AllocScope(const char* sName);
+		~AllocScope();
+		AllocScope(const AllocScope&) = delete;
+
+	private:
+		const char* sName;
+		AllocStats start;
+	};
+
+	// Moves the scope totals gathered so far into vOut and starts them again from zero
+	void CollectAllocScopes(std::vector<AllocScopeStats>& vOut);
+
+#if defined(OLC_ALLOC_STATS)
+	#define OLC_ALLOC_SCOPE_JOIN(a, b) a##b
+	#define OLC_ALLOC_SCOPE_NAME(line) OLC_ALLOC_SCOPE_JOIN(olc_alloc_scope_, line)
+	#define OLC_ALLOC_SCOPE(name) olc::AllocScope OLC_ALLOC_SCOPE_NAME(__LINE__)(name)
+#else
+	#define OLC_ALLOC_SCOPE(name)
+#endif
+
+	// O------------------------------------------------------------------------------O
+	// | olc::Profiler - Scoped timing zones, saved as Chrome trace_event JSON        |
+	// O------------------------------------------------------------------------------O
+	// Defining OLC_PROFILE where the engine is compiled turns OLC_PROFILE_ZONE into a
+	// timed zone. Each thread writes into a ring of its own, so recording takes no lock,
+	// and once a ring is full the oldest events are overwritten. The saved file opens in
+	// chrome://tracing, ui.perfetto.dev and Tracy's importer
+	struct ProfileEvent
+	{
+		const char* sName = nullptr;
+		int64_t nStart = 0;	// Nanoseconds on the steady clock
+		int64_t nEnd = 0;
+	};
+
+	// Records a finished zone on the calling thread's ring, sName must be a string literal
+	void ProfileRecord(const char* sName, std::chrono::steady_clock::time_point tpStart, std::chrono::steady_clock::time_point tpEnd);
+	// Writes what every thread's ring still holds, can be called while zones are recording
+	olc::rcode SaveProfileTrace(const std::string& sFile);
+
+	class ProfileZone
+	{
+	public:
+		explicit ProfileZone(const char* sName) : sName(sName), tpStart(std::chrono::steady_clock::now()) {}
+		~ProfileZone() { ProfileRecord(sName, tpStart, std::chrono::steady_clock::now()); }
+		ProfileZone(const ProfileZone&) = delete;
+
+	private:
+		const char* sName;
+		std::chrono::steady_clock::time_point tpStart;
+	};
+
+#if defined(OLC_PROFILE)
+	#define OLC_PROFILE_ZONE_JOIN(a, b) a##b
+	#define OLC_PROFILE_ZONE_NAME(line) OLC_PROFILE_ZONE_JOIN(olc_profile_zone_, line)
+	#define OLC_PROFILE_ZONE(name) olc::ProfileZone OLC_PROFILE_ZONE_NAME(__LINE__)(name)
+#else
+	#define OLC_PROFILE_ZONE(name)
+#endif
+
+	// O------------------------------------------------------------------------------O
+	// | olc::WorkerPool - A fixed set of threads that share out numbered jobs        |
+	// O------------------------------------------------------------------------------O
+	class WorkerPool
+	{
+	public:
+		WorkerPool() = default;
+		WorkerPool(const WorkerPool&) = delete;
+		~WorkerPool();
+
+	public:
+		// (Re)starts the pool with n background threads, 0 runs everything on the caller
+		void Start(uint32_t nThreads);
+		void Stop();
+		uint32_t Size() const;
+		// Calls job(0) to job(nJobs - 1) spread across the pool and the calling thread,
+		// returns once every job has finished
+		void Run(uint32_t nJobs, const std::function<void(uint32_t)>& job);
+
+	private:
+		void Worker();
+		void Drain(const std::function<void(uint32_t)>& job, uint32_t nJobs);
+
+		std::vector<std::thread> vThreads;
+		std::mutex muxPool;
+		std::condition_variable cvWork;
+		std::condition_variable cvDone;
+		const std::function<void(uint32_t)>* pJob = nullptr;
+		uint32_t nJobCount = 0;
+		std::atomic<uint32_t> nNextJob{ 0 };
+		uint32_t nBusy = 0;
+		uint64_t nBatch = 0;
+		bool bQuit = false;
+	};
+
+	// O------------------------------------------------------------------------------O
+	// | olc::FrameArena - Linear memory that is handed back all at once              |
+	// O------------------------------------------------------------------------------O
+	class FrameArena
+	{
+	public:
+		FrameArena() = default;
+		FrameArena(const FrameArena&) = delete;
+
+	public:
+		// Space for n default constructed T, valid until the next Reset(). Nothing
+		// in the arena is ever destroyed, so T must not need a destructor
+		template<typename T> T* Allocate(size_t n)
+		{
+			static_assert(std::is_trivially_destructible<T>::value, "FrameArena never runs destructors");
+			static_assert(alignof(T) <= alignof(std::max_align_t), "FrameArena blocks are max_align_t aligned");
+			const size_t nBytes = sizeof(T) * n;
+			size_t nOffset = (nUsed + alignof(T) - 1) & ~(alignof(T) - 1);
+			if (nBlock >= vBlocks.size() || nOffset + nBytes > vBlocks[nBlock].nSize)
+			{
+				NextBlock(nBytes);
+				nOffset = 0;
+			}
+			T* p = reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(vBlocks[nBlock].pData.get()) + nOffset);
+			nUsed = nOffset + nBytes;
+			for (size_t i = 0; i < n; i++) new (p + i) T;
+			return p;
+		}
+		// Hands everything back, the blocks are kept so a steady load allocates nothing
+		void Reset();
+		// Bytes held across all blocks
+		size_t Capacity() const;
+
+	private:
+		void NextBlock(size_t nBytes);
+
+		struct Block
+		{
+			std::unique_ptr<std::max_align_t[]> pData;
+			size_t nSize = 0;
+		};
+		static constexpr size_t nBlockSize = 64 * 1024;
+		std::vector<Block> vBlocks;
+		size_t nBlock = 0;
+		size_t nUsed = 0;
+	};
+
+	// O------------------------------------------------------------------------------O
+	// | olc::SpriteCache - Generated sprites kept within a memory budget             |
+	// O------------------------------------------------------------------------------O
+	// Entries are named by what they were generated from, so asking again for the same
+	// content finds the same sprite
+	struct SpriteKey
+	{
+		uint32_t nType = 0;		// What kind of image, chosen by the caller
+		uint64_t nSeed = 0;		// What it was generated from
+		olc::vi2d vSize = { 0, 0 };
+
+		bool operator==(const SpriteKey& k) const { return nType == k.nType && nSeed == k.nSeed && vSize == k.vSize; }
+	};
+
+	class SpriteCache
+	{
+	public:
+		explicit SpriteCache(size_t nBudgetBytes = 64 * 1024 * 1024);
+		SpriteCache(const SpriteCache&) = delete;
+
+	public:
+		// The sprite for key, on a miss funcCreate paints a new sprite of key's size. May
+		// evict least recently used entries to stay within budget, but never ones used
+		// since the last NextFrame(), so pointers stay valid until then
+		olc::Sprite* Get(const SpriteKey& key, const std::function<void(olc::Sprite&)>& funcCreate);
+		// As Get(), with a GPU texture made from the sprite. Its bytes count twice
+		olc::Decal* GetDecal(const SpriteKey& key, const std::function<void(olc::Sprite&)>& funcCreate);
+		// Call once a frame before drawing, entries used before it may be evicted again
+		void NextFrame();
+		void SetBudget(size_t nBudgetBytes);
+		size_t GetBudget() const;
+		// Bytes of sprites and textures held
+		size_t GetResidentBytes() const;
+		size_t GetEntryCount() const;
+		uint64_t GetHits() const;
+		uint64_t GetMisses() const;
+		// Hits over lookups, 0 before the first
+		float GetHitRate() const;
+		// Drops every entry, even ones in use this frame
+		void Clear();
+
+	private:
+		struct KeyHash
+		{
+			size_t operator()(const SpriteKey& k) const
+			{ return std::hash<uint64_t>()(k.nSeed ^ (uint64_t(k.nType) << 48) ^ (uint64_t(uint32_t(k.vSize.x)) << 24) ^ uint64_t(uint32_t(k.vSize.y))); }
+		};
+
+		struct Entry
+		{
+			SpriteKey key;
+			std::unique_ptr<olc::Sprite> pSprite;
+			// Deleting the decal frees its texture through Renderer::DeleteTexture
+			std::unique_ptr<olc::Decal> pDecal;
+			uint64_t nFrame = 0;
+		};
+
+		Entry& Find(const SpriteKey& key, const std::function<void(olc::Sprite&)>& funcCreate);
+		void Evict();
+		static size_t EntryBytes(const Entry& e);
+
+		// Most recently used first
+		std::list<Entry> listEntries;
+		std::unordered_map<SpriteKey, std::list<Entry>::iterator, KeyHash> mapEntries;
+		size_t nBudget;
+		size_t nResident = 0;
+		uint64_t nFrame = 0;
+		uint64_t nHits = 0;
+		uint64_t nMisses = 0;
+	};
+
 	class PGEX;
 
 	// The Static Twins (plus one)
@@ -906,6 +1250,9 @@ namespace olc
 		virtual bool OnUserCreate();
 		// Called every frame, and provides you with a time per frame value
 		virtual bool OnUserUpdate(float fElapsedTime);
+		// Called before OnUserUpdate once per simulation tick, see SetFixedTimestep(). Poll
+		// held keys here, pressed and released ones are only seen in ticks of that frame
+		virtual bool OnFixedUpdate(float fStep);
 		// Called once on application termination, so you can be one clean coder
 		virtual bool OnUserDestroy();
 
@@ -949,15 +1296,32 @@ namespace olc
 		uint32_t GetFPS() const;
 		// Gets last update of elapsed time
 		float GetElapsedTime() const;
+		// How far the frame is between the last tick and the next one, 0 to 1, for
+		// interpolating what OnFixedUpdate moves. Always 1 without a fixed timestep
+		float GetFixedAlpha() const;
+		// Simulation ticks run so far
+		uint64_t GetFixedTick() const;
 		// Gets Actual Window size
 		const olc::vi2d& GetWindowSize() const;
 		// Gets pixel scale
 		const olc::vi2d& GetPixelSize() const;
 		// Gets actual pixel scale
 		const olc::vi2d& GetScreenPixelSize() const;
+		// Gets p50/p95/p99 of each frame phase over the last nFrameHistory frames
+		olc::FrameStats GetFrameStats() const;
+		// Shows frame time percentiles on top of everything else
+		void ShowFrameStats(bool bShow);
+		// Writes the recorded frame timings as CSV, oldest first
+		olc::rcode SaveFrameStats(const std::string& sFile) const;
+#if defined(OLC_PLATFORM_HEADLESS)
+		// Offscreen run settings, configure before calling Start()
+		olc::HeadlessConfig& GetHeadlessConfig();
+#endif
 
 	public: // CONFIGURATION ROUTINES
-		// Layer targeting functions
+		// Layer targeting functions. A layer is only uploaded in frames where it has
+		// been drawn to, code that writes a layer's sprite directly should mark it by
+		// calling SetDrawTarget(layer)
 		void SetDrawTarget(uint8_t layer);
 		void EnableLayer(uint8_t layer, bool b);
 		void SetLayerOffset(uint8_t layer, const olc::vf2d& offset);
@@ -980,6 +1344,38 @@ namespace olc
 		void SetPixelMode(std::function<olc::Pixel(const int x, const int y, const olc::Pixel& pSource, const olc::Pixel& pDest)> pixelMode);
 		// Change the blend factor from between 0.0f to 1.0f;
 		void SetPixelBlend(float fBlend);
+		// Command list mode - FillCircle, FillRect, DrawString, DrawSprite, DrawPartialSprite
+		// and Clear are recorded instead of drawn, binned into square tiles of the draw
+		// target and the tiles rasterised in parallel on nThreads (0 = all hardware threads).
+		// Output is identical to immediate mode. Any other drawing routine, changing draw
+		// target and the end of the frame flush the list, so sprites passed to DrawSprite
+		// must stay unchanged until then. Recorded commands bypass overrides of Draw(), and
+		// CUSTOM pixel mode always draws immediately
+		void EnableCommandList(bool bEnable, uint32_t nThreads = 0, int32_t nTileSize = 64);
+		// Rasterises everything recorded so far
+		void FlushCommandList();
+		// Caps the frame rate, sleeping through most of the wait and spinning the last
+		// stretch for accuracy. 0 = run as fast as possible
+		void SetFrameRateLimit(float fMaxFPS);
+		// Idle mode - frames only run when input arrives or RequestFrame() is called,
+		// otherwise the engine thread sleeps and the last frame stays on screen
+		void EnableIdleMode(bool bEnable);
+		// Asks for another frame even if there is no input, e.g. while animating
+		void RequestFrame();
+		// Runs OnFixedUpdate in ticks of fStep seconds, as many as the elapsed time covers
+		// but at most nMaxTicks a frame, after which the backlog is dropped rather than
+		// caught up. 0 = one tick per frame of fElapsedTime
+		void SetFixedTimestep(float fStep, uint32_t nMaxTicks = 8);
+		// Call from OnUserUpdate when nothing changed, the previous frame stays on screen
+		// and no layers are uploaded or presented. Ignored by the headless platform
+		void SkipFrame();
+		// Writes every frame's keyboard, mouse and fElapsedTime to a binary file until the
+		// engine stops, only what changed since the previous frame is stored
+		olc::rcode RecordInput(const std::string& sFile);
+		// Plays a recording back instead of live input, one recorded frame per frame, and
+		// stops the engine after the last. OnUserUpdate gets the recorded fElapsedTime, or
+		// fFixedStep when it is above 0. Idle mode is ignored while replaying
+		olc::rcode ReplayInput(const std::string& sFile, float fFixedStep = 0.0f);
 
 
 
@@ -1008,17 +1404,19 @@ namespace olc
 		// Flat fills a triangle between points (x1,y1), (x2,y2) and (x3,y3)
 		void FillTriangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p = olc::WHITE);
 		void FillTriangle(const olc::vi2d& pos1, const olc::vi2d& pos2, const olc::vi2d& pos3, Pixel p = olc::WHITE);
-		// Draws an entire sprite at location (x,y)
+		// Draws an entire sprite at location (x,y). In NORMAL, MASK and ALPHA modes whole rows
+		// are copied, bypassing overrides of Draw(), unless the area reaches outside the sprite
+		// or the sprite is the draw target
 		void DrawSprite(int32_t x, int32_t y, Sprite* sprite, uint32_t scale = 1, uint8_t flip = olc::Sprite::NONE);
 		void DrawSprite(const olc::vi2d& pos, Sprite* sprite, uint32_t scale = 1, uint8_t flip = olc::Sprite::NONE);
 		// Draws an area of a sprite at location (x,y), where the
-		// selected area is (ox,oy) to (ox+w,oy+h)
+		// selected area is (ox,oy) to (ox+w,oy+h). Bypasses overrides of Draw() as DrawSprite does
 		void DrawPartialSprite(int32_t x, int32_t y, Sprite* sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, uint32_t scale = 1, uint8_t flip = olc::Sprite::NONE);
 		void DrawPartialSprite(const olc::vi2d& pos, Sprite* sprite, const olc::vi2d& sourcepos, const olc::vi2d& size, uint32_t scale = 1, uint8_t flip = olc::Sprite::NONE);
 		// Draws a single line of text - traditional monospaced
-		void DrawString(int32_t x, int32_t y, const std::string& sText, Pixel col = olc::WHITE, uint32_t scale = 1);
-		void DrawString(const olc::vi2d& pos, const std::string& sText, Pixel col = olc::WHITE, uint32_t scale = 1);
-		olc::vi2d GetTextSize(const std::string& s);
+		void DrawString(int32_t x, int32_t y, std::string_view sText, Pixel col = olc::WHITE, uint32_t scale = 1);
+		void DrawString(const olc::vi2d& pos, std::string_view sText, Pixel col = olc::WHITE, uint32_t scale = 1);
+		olc::vi2d GetTextSize(std::string_view s);
 		// Draws a single line of text - non-monospaced
 		void DrawStringProp(int32_t x, int32_t y, const std::string& sText, Pixel col = olc::WHITE, uint32_t scale = 1);
 		void DrawStringProp(const olc::vi2d& pos, const std::string& sText, Pixel col = olc::WHITE, uint32_t scale = 1);
@@ -1102,6 +1500,7 @@ namespace olc
 
 	private: // Inner mysterious workings
 		olc::Sprite*     pDrawTarget = nullptr;
+		int32_t		nDrawTargetLayer = -1;	// Layer whose sprite is pDrawTarget, or -1
 		Pixel::Mode	nPixelMode = Pixel::NORMAL;
 		float		fBlendFactor = 1.0f;
 		olc::vi2d	vScreenSize = { 256, 240 };
@@ -1133,8 +1532,80 @@ namespace olc
 		DecalMode   nDecalMode = DecalMode::NORMAL;
 		DecalStructure nDecalStructure = DecalStructure::FAN;
 		std::function<olc::Pixel(const int x, const int y, const olc::Pixel&, const olc::Pixel&)> funcPixelMode;
-		std::chrono::time_point<std::chrono::system_clock> m_tp1, m_tp2;
+		std::chrono::time_point<std::chrono::steady_clock> m_tp1, m_tp2;
 		std::vector<olc::vi2d> vFontSpacing;
+#if defined(OLC_PLATFORM_HEADLESS)
+		olc::HeadlessConfig headlessConfig;
+#endif
+
+		// Command list
+		bool		bCommandList = false;
+		int32_t		nCommandTileSize = 64;
+		std::vector<DrawCommand> vDrawCommands;
+		std::string sCommandText;
+		std::vector<std::vector<uint32_t>> vCommandTiles;
+		olc::WorkerPool poolRaster;
+
+		// Decal geometry for the frame being built, reset once it has been drawn
+		olc::FrameArena arenaDecals;
+		void		AllocateDecalGeometry(DecalInstance& di, uint32_t nPoints);
+		template<typename T> static void SetDecalPoints(T* p, std::initializer_list<typename std::decay<T>::type> values)
+		{ std::copy(values.begin(), values.end(), p); }
+
+		// Frame timing, a ring buffer of the last nFrameHistory frames
+		std::vector<FrameTiming> vFrameTimings;
+		size_t		nFrameTimingNext = 0;
+		uint32_t	nFrameIndex = 0;
+		bool		bShowFrameStats = false;
+		std::vector<AllocScopeStats> vAllocScopes;	// As of the last frame
+		void		DrawFrameStats();
+
+		// Frame pacing and idle mode
+		float		fFrameRateLimit = 0.0f;
+		std::chrono::time_point<std::chrono::steady_clock> tpNextFrame;
+		bool		bIdleMode = false;
+		bool		bSkipFrame = false;
+		float		fFixedStep = 0.0f;
+		uint32_t	nFixedMaxTicks = 8;
+		float		fFixedAccumulator = 0.0f;
+		float		fFixedAlpha = 1.0f;
+		uint64_t	nFixedTick = 0;
+		bool		bForcePresent = true;
+		std::atomic<bool> bFrameRequested{ true };
+		std::atomic<uint32_t> nInputEvents{ 0 };
+		uint32_t	nInputEventsSeen = 0;
+		std::mutex	muxIdle;
+		std::condition_variable cvIdle;
+		void		NotifyInput();
+		void		PaceFrame();
+
+		// Input recording and replay, the logged state is what the file holds as of the
+		// last frame written or read
+		std::ofstream ofsInputRecord;
+		std::vector<uint8_t> vInputReplay;
+		size_t		nInputReplayNext = 0;
+		bool		bInputReplay = false;
+		float		fInputReplayStep = 0.0f;
+		bool		pKeyLogged[256] = { 0 };
+		bool		pMouseLogged[nMouseButtons] = { 0 };
+		olc::vi2d	vMouseLogged = { 0, 0 };
+		void		RecordInputFrame(float fElapsedTime);
+		bool		ReplayInputFrame(float& fElapsedTime);
+
+		// Drawing into a layer's sprite queues it for upload
+		void		MarkDrawTargetDirty() { if (nDrawTargetLayer >= 0) vLayers[nDrawTargetLayer].bUpdate = true; }
+
+		// Rasterisers shared by immediate and command list drawing, plot(x, y, p) is
+		// called for each covered pixel inside the clip window [vClipMin, vClipMax)
+		template<typename F> void RasterFillRect(int32_t x, int32_t y, int32_t w, int32_t h, const olc::vi2d& vClipMin, const olc::vi2d& vClipMax, Pixel p, F&& plot);
+		template<typename F> void RasterFillCircle(int32_t x, int32_t y, int32_t radius, const olc::vi2d& vClipMin, const olc::vi2d& vClipMax, Pixel p, F&& plot);
+		template<typename F> void RasterString(int32_t x, int32_t y, const char* sText, size_t nLength, uint32_t scale, const olc::vi2d& vClipMin, const olc::vi2d& vClipMax, Pixel col, F&& plot);
+		template<typename F> void RasterSprite(int32_t x, int32_t y, const Sprite* sprite, const olc::vi2d& vSource, const olc::vi2d& vSize, uint32_t scale, uint8_t flip, const olc::vi2d& vClipMin, const olc::vi2d& vClipMax, F&& plot);
+		// Row by row sprite copy for NORMAL, MASK and ALPHA modes, the source area must lie
+		// inside the sprite and the sprite must not be the target
+		static void BlitSprite(Sprite* target, int32_t x, int32_t y, const Sprite* sprite, const olc::vi2d& vSource, const olc::vi2d& vSize, uint32_t scale, uint8_t flip, const olc::vi2d& vClipMin, const olc::vi2d& vClipMax, Pixel::Mode mode, float fBlend);
+		void RecordCommand(DrawCommand& cmd);
+		void ExecuteCommand(const DrawCommand& cmd, const olc::vi2d& vClipMin, const olc::vi2d& vClipMax);
 
 		// State of keyboard		
 		bool		pKeyNewState[256] = { 0 };
@@ -1225,6 +1696,180 @@ namespace olc
 // | Note: The core implementation is platform independent                        |
 // O------------------------------------------------------------------------------O
 #pragma region pge_implementation
+// O------------------------------------------------------------------------------O
+// | olc::AllocStats IMPLEMENTATION                                               |
+// O------------------------------------------------------------------------------O
+namespace olc
+{
+	namespace alloc
+	{
+		// Plain counters only, these are touched from inside operator new
+		static std::atomic<uint64_t> nAllocations{ 0 };
+		static std::atomic<uint64_t> nBytes{ 0 };
+		static std::atomic<uint64_t> nFrees{ 0 };
+		static thread_local AllocStats statsThread;
+		static std::mutex muxScopes;
+		static std::vector<AllocScopeStats> vScopes;
+	}
+
+	AllocStats GetAllocStats()
+	{
+		AllocStats stats;
+		stats.nAllocations = alloc::nAllocations.load(std::memory_order_relaxed);
+		stats.nBytes = alloc::nBytes.load(std::memory_order_relaxed);
+		stats.nFrees = alloc::nFrees.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	AllocStats GetThreadAllocStats()
+	{ return alloc::statsThread; }
+
+	AllocScope::AllocScope(const char* sName) : sName(sName), start(alloc::statsThread)
+	{ }
+
+	AllocScope::~AllocScope()
+	{
+		const AllocStats end = alloc::statsThread;
+		std::lock_guard<std::mutex> lock(alloc::muxScopes);
+		auto it = std::find_if(alloc::vScopes.begin(), alloc::vScopes.end(), [&](const AllocScopeStats& s) { return s.sName == sName; });
+		if (it == alloc::vScopes.end())
+		{
+			alloc::vScopes.emplace_back();
+			it = alloc::vScopes.end() - 1;
+			it->sName = sName;
+		}
+		it->nEntries++;
+		it->stats.nAllocations += end.nAllocations - start.nAllocations;
+		it->stats.nBytes += end.nBytes - start.nBytes;
+		it->stats.nFrees += end.nFrees - start.nFrees;
+	}
+
+	void CollectAllocScopes(std::vector<AllocScopeStats>& vOut)
+	{
+		std::lock_guard<std::mutex> lock(alloc::muxScopes);
+		vOut.assign(alloc::vScopes.begin(), alloc::vScopes.end());
+		// Names stay registered, so a steady set of scopes stops allocating here
+		for (auto& scope : alloc::vScopes) { scope.nEntries = 0; scope.stats = AllocStats(); }
+	}
+}
+
+#if defined(OLC_ALLOC_STATS)
+void* operator new(std::size_t nSize)
+{
+	olc::alloc::nAllocations.fetch_add(1, std::memory_order_relaxed);
+	olc::alloc::nBytes.fetch_add(nSize, std::memory_order_relaxed);
+	olc::alloc::statsThread.nAllocations++;
+	olc::alloc::statsThread.nBytes += nSize;
+	if (void* p = std::malloc(nSize ? nSize : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	if (p == nullptr) return;
+	olc::alloc::nFrees.fetch_add(1, std::memory_order_relaxed);
+	olc::alloc::statsThread.nFrees++;
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{ operator delete(p); }
+#endif
+
+// O------------------------------------------------------------------------------O
+// | olc::Profiler IMPLEMENTATION                                                 |
+// O------------------------------------------------------------------------------O
+namespace olc
+{
+	namespace profile
+	{
+		// Written by its own thread only, nWritten is published after the event it counts
+		struct Ring
+		{
+			static constexpr uint64_t nSize = 1 << 16;
+			std::array<ProfileEvent, nSize> vEvents;
+			std::atomic<uint64_t> nWritten{ 0 };
+			uint32_t nThread = 0;
+		};
+
+		// The lock is only taken the first time a thread records, and when saving
+		static std::mutex muxRings;
+		static std::vector<std::unique_ptr<Ring>> vRings;
+		static thread_local Ring* pRing = nullptr;
+
+		static int64_t Nanoseconds(std::chrono::steady_clock::time_point tp)
+		{ return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count(); }
+	}
+
+	void ProfileRecord(const char* sName, std::chrono::steady_clock::time_point tpStart, std::chrono::steady_clock::time_point tpEnd)
+	{
+		if (profile::pRing == nullptr)
+		{
+			std::lock_guard<std::mutex> lock(profile::muxRings);
+			profile::vRings.push_back(std::make_unique<profile::Ring>());
+			profile::pRing = profile::vRings.back().get();
+			profile::pRing->nThread = uint32_t(profile::vRings.size());
+		}
+
+		profile::Ring& ring = *profile::pRing;
+		const uint64_t n = ring.nWritten.load(std::memory_order_relaxed);
+		ProfileEvent& e = ring.vEvents[n % profile::Ring::nSize];
+		e.sName = sName;
+		e.nStart = profile::Nanoseconds(tpStart);
+		e.nEnd = profile::Nanoseconds(tpEnd);
+		ring.nWritten.store(n + 1, std::memory_order_release);
+	}
+
+	olc::rcode SaveProfileTrace(const std::string& sFile)
+	{
+		struct Entry { ProfileEvent e; uint32_t nThread; };
+		std::vector<Entry> vEntries;
+		{
+			std::lock_guard<std::mutex> lock(profile::muxRings);
+			for (auto& ring : profile::vRings)
+			{
+				const uint64_t nEnd = ring->nWritten.load(std::memory_order_acquire);
+				const uint64_t nBegin = nEnd > profile::Ring::nSize ? nEnd - profile::Ring::nSize : 0;
+				const size_t nFirst = vEntries.size();
+				for (uint64_t i = nBegin; i < nEnd; i++)
+					vEntries.push_back({ ring->vEvents[i % profile::Ring::nSize], ring->nThread });
+
+				// Slots the thread lapped while they were copied are dropped rather than trusted, as is
+				// the slot of event nNow, which it may be writing now
+				const uint64_t nNow = ring->nWritten.load(std::memory_order_acquire);
+				const uint64_t nValid = nNow + 1 > profile::Ring::nSize ? nNow + 1 - profile::Ring::nSize : 0;
+				if (nValid > nBegin)
+					vEntries.erase(vEntries.begin() + nFirst, vEntries.begin() + nFirst + size_t(std::min(nValid, nEnd) - nBegin));
+			}
+		}
+
+		std::ofstream file(sFile);
+		if (!file.is_open()) return olc::FAIL;
+
+		int64_t nOrigin = INT64_MAX;
+		for (const auto& entry : vEntries) nOrigin = std::min(nOrigin, entry.e.nStart);
+
+		// Complete ("X") events, timestamps in microseconds from the earliest zone
+		file << "{\"traceEvents\":[";
+		file << std::fixed << std::setprecision(3);
+		for (size_t i = 0; i < vEntries.size(); i++)
+		{
+			const Entry& entry = vEntries[i];
+			file << (i ? ",\n" : "\n") << "{\"name\":\"";
+			for (const char* c = entry.e.sName; *c; c++)
+			{
+				if (*c == '"' || *c == '\\') file << '\\';
+				file << *c;
+			}
+			file << "\",\"ph\":\"X\",\"ts\":" << double(entry.e.nStart - nOrigin) / 1000.0
+				<< ",\"dur\":" << double(entry.e.nEnd - entry.e.nStart) / 1000.0
+				<< ",\"pid\":1,\"tid\":" << entry.nThread << "}";
+		}
+		file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+		return file.good() ? olc::OK : olc::FAIL;
+	}
+}
+
 namespace olc
 {
 	// O------------------------------------------------------------------------------O
@@ -1681,6 +2326,220 @@ namespace olc
 		return o;
 	};
 
+	// O------------------------------------------------------------------------------O
+	// | olc::FrameArena IMPLEMENTATION                                               |
+	// O------------------------------------------------------------------------------O
+	void FrameArena::Reset()
+	{
+		nBlock = 0;
+		nUsed = 0;
+	}
+
+	size_t FrameArena::Capacity() const
+	{
+		size_t nBytes = 0;
+		for (const auto& block : vBlocks) nBytes += block.nSize;
+		return nBytes;
+	}
+
+	void FrameArena::NextBlock(size_t nBytes)
+	{
+		// Move on from the current block, the first request ever has none to move from
+		if (nBlock < vBlocks.size()) nBlock++;
+		if (nBlock == vBlocks.size()) vBlocks.emplace_back();
+
+		// Blocks only ever grow, oversized requests get a block of their own size
+		Block& block = vBlocks[nBlock];
+		if (block.nSize < nBytes || block.nSize == 0)
+		{
+			block.nSize = std::max(nBlockSize, nBytes);
+			block.pData.reset(new std::max_align_t[(block.nSize + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t)]);
+		}
+		nUsed = 0;
+	}
+
+	// O------------------------------------------------------------------------------O
+	// | olc::SpriteCache IMPLEMENTATION                                              |
+	// O------------------------------------------------------------------------------O
+	SpriteCache::SpriteCache(size_t nBudgetBytes) : nBudget(nBudgetBytes)
+	{ }
+
+	olc::Sprite* SpriteCache::Get(const SpriteKey& key, const std::function<void(olc::Sprite&)>& funcCreate)
+	{ return Find(key, funcCreate).pSprite.get(); }
+
+	olc::Decal* SpriteCache::GetDecal(const SpriteKey& key, const std::function<void(olc::Sprite&)>& funcCreate)
+	{
+		Entry& e = Find(key, funcCreate);
+		if (!e.pDecal)
+		{
+			e.pDecal = std::make_unique<olc::Decal>(e.pSprite.get());
+			nResident += EntryBytes(e) / 2;
+			Evict();
+		}
+		return e.pDecal.get();
+	}
+
+	SpriteCache::Entry& SpriteCache::Find(const SpriteKey& key, const std::function<void(olc::Sprite&)>& funcCreate)
+	{
+		auto it = mapEntries.find(key);
+		if (it != mapEntries.end())
+		{
+			nHits++;
+			listEntries.splice(listEntries.begin(), listEntries, it->second);
+			it->second->nFrame = nFrame;
+			return *it->second;
+		}
+
+		nMisses++;
+		listEntries.emplace_front();
+		Entry& e = listEntries.front();
+		e.key = key;
+		e.nFrame = nFrame;
+		e.pSprite = std::make_unique<olc::Sprite>(key.vSize.x, key.vSize.y);
+		funcCreate(*e.pSprite);
+		mapEntries.emplace(key, listEntries.begin());
+		nResident += EntryBytes(e);
+		Evict();
+		return e;
+	}
+
+	void SpriteCache::Evict()
+	{
+		// The oldest entries sit at the back, stop at the first one in use this frame
+		while (nResident > nBudget && !listEntries.empty() && listEntries.back().nFrame != nFrame)
+		{
+			nResident -= EntryBytes(listEntries.back());
+			mapEntries.erase(listEntries.back().key);
+			listEntries.pop_back();
+		}
+	}
+
+	size_t SpriteCache::EntryBytes(const Entry& e)
+	{
+		const size_t nBytes = size_t(e.key.vSize.x) * size_t(e.key.vSize.y) * sizeof(olc::Pixel);
+		return e.pDecal ? nBytes * 2 : nBytes;
+	}
+
+	void SpriteCache::NextFrame()
+	{
+		nFrame++;
+		Evict();
+	}
+
+	void SpriteCache::SetBudget(size_t nBudgetBytes)
+	{
+		nBudget = nBudgetBytes;
+		Evict();
+	}
+
+	size_t SpriteCache::GetBudget() const
+	{ return nBudget; }
+
+	size_t SpriteCache::GetResidentBytes() const
+	{ return nResident; }
+
+	size_t SpriteCache::GetEntryCount() const
+	{ return listEntries.size(); }
+
+	uint64_t SpriteCache::GetHits() const
+	{ return nHits; }
+
+	uint64_t SpriteCache::GetMisses() const
+	{ return nMisses; }
+
+	float SpriteCache::GetHitRate() const
+	{ return nHits + nMisses > 0 ? float(nHits) / float(nHits + nMisses) : 0.0f; }
+
+	void SpriteCache::Clear()
+	{
+		mapEntries.clear();
+		listEntries.clear();
+		nResident = 0;
+	}
+
+	// O------------------------------------------------------------------------------O
+	// | olc::WorkerPool IMPLEMENTATION                                               |
+	// O------------------------------------------------------------------------------O
+	WorkerPool::~WorkerPool()
+	{ Stop(); }
+
+	void WorkerPool::Start(uint32_t nThreads)
+	{
+		Stop();
+		bQuit = false;
+		for (uint32_t i = 0; i < nThreads; i++)
+			vThreads.emplace_back(&WorkerPool::Worker, this);
+	}
+
+	void WorkerPool::Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(muxPool);
+			bQuit = true;
+		}
+		cvWork.notify_all();
+		for (auto& t : vThreads) t.join();
+		vThreads.clear();
+		// Workers started next count batches from 0, else they would take the last one for theirs
+		nBatch = 0;
+	}
+
+	uint32_t WorkerPool::Size() const
+	{ return uint32_t(vThreads.size()); }
+
+	void WorkerPool::Run(uint32_t nJobs, const std::function<void(uint32_t)>& job)
+	{
+		if (nJobs == 0) return;
+
+		if (vThreads.empty() || nJobs == 1)
+		{
+			for (uint32_t i = 0; i < nJobs; i++) job(i);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(muxPool);
+			pJob = &job;
+			nJobCount = nJobs;
+			nNextJob = 0;
+			nBusy = uint32_t(vThreads.size());
+			nBatch++;
+		}
+		cvWork.notify_all();
+
+		// The caller works too, rather than sitting idle
+		Drain(job, nJobs);
+
+		std::unique_lock<std::mutex> lock(muxPool);
+		cvDone.wait(lock, [this] { return nBusy == 0; });
+		pJob = nullptr;
+	}
+
+	void WorkerPool::Drain(const std::function<void(uint32_t)>& job, uint32_t nJobs)
+	{
+		for (uint32_t i = nNextJob++; i < nJobs; i = nNextJob++)
+			job(i);
+	}
+
+	void WorkerPool::Worker()
+	{
+		uint64_t nSeenBatch = 0;
+		std::unique_lock<std::mutex> lock(muxPool);
+		while (true)
+		{
+			cvWork.wait(lock, [&] { return bQuit || nBatch != nSeenBatch; });
+			if (bQuit) return;
+
+			nSeenBatch = nBatch;
+			const auto* job = pJob;
+			const uint32_t nJobs = nJobCount;
+			lock.unlock();
+			Drain(*job, nJobs);
+			lock.lock();
+			if (--nBusy == 0) cvDone.notify_one();
+		}
+	}
+
 	// O------------------------------------------------------------------------------O
 	// | olc::PixelGameEngine IMPLEMENTATION                                          |
 	// O------------------------------------------------------------------------------O
@@ -1717,6 +2576,7 @@ namespace olc
 
 	void PixelGameEngine::SetScreenSize(int w, int h)
 	{
+		FlushCommandList();
 		vScreenSize = { w, h };
 		vInvScreenSize = { 1.0f / float(w), 1.0f / float(h) };
 		for (auto& layer : vLayers)
@@ -1758,13 +2618,18 @@ namespace olc
 
 	void PixelGameEngine::SetDrawTarget(Sprite* target)
 	{
+		FlushCommandList();
 		if (target)
 		{
 			pDrawTarget = target;
+			nDrawTargetLayer = -1;
+			for (size_t i = 0; i < vLayers.size(); i++)
+				if (vLayers[i].pDrawTarget.Sprite() == target) nDrawTargetLayer = int32_t(i);
 		}
 		else
 		{
 			nTargetLayer = 0;
+			nDrawTargetLayer = 0;
 			pDrawTarget = vLayers[0].pDrawTarget.Sprite();
 		}
 	}
@@ -1773,9 +2638,11 @@ namespace olc
 	{
 		if (layer < vLayers.size())
 		{
+			FlushCommandList();
 			pDrawTarget = vLayers[layer].pDrawTarget.Sprite();
 			vLayers[layer].bUpdate = true;
 			nTargetLayer = layer;
+			nDrawTargetLayer = layer;
 		}
 	}
 
@@ -1863,6 +2730,12 @@ namespace olc
 	float PixelGameEngine::GetElapsedTime() const
 	{ return fLastElapsed; }
 
+	float PixelGameEngine::GetFixedAlpha() const
+	{ return fFixedAlpha; }
+
+	uint64_t PixelGameEngine::GetFixedTick() const
+	{ return nFixedTick; }
+
 	const olc::vi2d& PixelGameEngine::GetWindowSize() const
 	{ return vWindowSize; }
 
@@ -1875,15 +2748,123 @@ namespace olc
 	const olc::vi2d& PixelGameEngine::GetWindowMouse() const
 	{ return vMouseWindowPos; }
 
-	bool PixelGameEngine::Draw(const olc::vi2d& pos, Pixel p)
-	{ return Draw(pos.x, pos.y, p); }
+#if defined(OLC_PLATFORM_HEADLESS)
+	olc::HeadlessConfig& PixelGameEngine::GetHeadlessConfig()
+	{ return headlessConfig; }
+#endif
 
-	// This is it, the critical function that plots a pixel
-	bool PixelGameEngine::Draw(int32_t x, int32_t y, Pixel p)
+	olc::FrameStats PixelGameEngine::GetFrameStats() const
 	{
-		if (!pDrawTarget) return false;
-
-		if (nPixelMode == Pixel::NORMAL)
+		static constexpr float FrameTiming::* phases[] =
+		{
+			&FrameTiming::fInput, &FrameTiming::fUpdate, &FrameTiming::fUpload,
+			&FrameTiming::fDecals, &FrameTiming::fPresent, &FrameTiming::fFrame
+		};
+
+		olc::FrameStats stats;
+		stats.nSamples = uint32_t(vFrameTimings.size());
+		if (vFrameTimings.empty()) return stats;
+
+		// Nearest rank percentiles, nth_element keeps this cheap enough to run per frame
+		std::vector<float> vSamples(vFrameTimings.size());
+		auto Rank = [&](float fPercent)
+		{
+			size_t n = size_t(std::ceil(fPercent / 100.0f * float(vSamples.size())));
+			n = std::min(std::max(n, size_t(1)), vSamples.size()) - 1;
+			std::nth_element(vSamples.begin(), vSamples.begin() + n, vSamples.end());
+			return vSamples[n];
+		};
+
+		for (auto phase : phases)
+		{
+			for (size_t i = 0; i < vFrameTimings.size(); i++)
+				vSamples[i] = vFrameTimings[i].*phase;
+			stats.p50.*phase = Rank(50.0f);
+			stats.p95.*phase = Rank(95.0f);
+			stats.p99.*phase = Rank(99.0f);
+		}
+		return stats;
+	}
+
+	void PixelGameEngine::ShowFrameStats(bool bShow)
+	{ bShowFrameStats = bShow; }
+
+	olc::rcode PixelGameEngine::SaveFrameStats(const std::string& sFile) const
+	{
+		std::ofstream file(sFile);
+		if (!file.is_open()) return olc::FAIL;
+
+		file << "frame,input_ms,update_ms,upload_ms,decals_ms,present_ms,frame_ms,draw_calls,vertices,allocs,alloc_bytes\n";
+		// Once the ring buffer has wrapped the oldest frame sits at the write position
+		const size_t nStart = vFrameTimings.size() < nFrameHistory ? 0 : nFrameTimingNext;
+		for (size_t i = 0; i < vFrameTimings.size(); i++)
+		{
+			const FrameTiming& t = vFrameTimings[(nStart + i) % vFrameTimings.size()];
+			file << t.nFrame << ',' << t.fInput << ',' << t.fUpdate << ',' << t.fUpload << ','
+				<< t.fDecals << ',' << t.fPresent << ',' << t.fFrame << ',' << t.nDrawCalls << ',' << t.nVertices << ','
+				<< t.nAllocations << ',' << t.nAllocBytes << '\n';
+		}
+		return file.good() ? olc::OK : olc::FAIL;
+	}
+
+	void PixelGameEngine::DrawFrameStats()
+	{
+		const olc::FrameStats stats = GetFrameStats();
+
+		std::ostringstream text;
+		text << std::fixed << std::setprecision(2);
+		text << std::left << std::setw(8) << "ms" << std::right << std::setw(7) << "p50" << std::setw(7) << "p95" << std::setw(7) << "p99";
+		auto Row = [&](const char* sName, float FrameTiming::* phase)
+		{
+			text << '\n' << std::left << std::setw(8) << sName << std::right
+				<< std::setw(7) << stats.p50.*phase << std::setw(7) << stats.p95.*phase << std::setw(7) << stats.p99.*phase;
+		};
+		Row("frame", &FrameTiming::fFrame);
+		Row("input", &FrameTiming::fInput);
+		Row("update", &FrameTiming::fUpdate);
+		Row("upload", &FrameTiming::fUpload);
+		Row("decals", &FrameTiming::fDecals);
+		Row("present", &FrameTiming::fPresent);
+		if (!vFrameTimings.empty())
+		{
+			const FrameTiming& last = vFrameTimings[(nFrameTimingNext + nFrameHistory - 1) % nFrameHistory];
+			text << "\ndraws " << last.nDrawCalls << "  verts " << last.nVertices;
+#if defined(OLC_ALLOC_STATS)
+			text << "\nallocs " << last.nAllocations << "  bytes " << last.nAllocBytes;
+			for (const auto& scope : vAllocScopes)
+				if (scope.nEntries > 0)
+					text << "\n " << scope.sName << ' ' << scope.stats.nAllocations << " / " << scope.stats.nBytes << 'B';
+#endif
+		}
+
+		// Layer 0 is drawn last, so its decals sit on top of everything
+		const uint8_t nLayer = nTargetLayer;
+		const DecalMode nMode = nDecalMode;
+		const DecalStructure nStructure = nDecalStructure;
+		nTargetLayer = 0;
+		nDecalMode = DecalMode::NORMAL;
+		nDecalStructure = DecalStructure::FAN;
+
+		const olc::vf2d vSize = olc::vf2d(GetTextSize(text.str())) + olc::vf2d(4.0f, 4.0f);
+		FillRectDecal({ 0.0f, 0.0f }, vSize, olc::Pixel(0, 0, 0, 192));
+		DrawStringDecal({ 2.0f, 2.0f }, text.str(), olc::YELLOW);
+
+		nTargetLayer = nLayer;
+		nDecalMode = nMode;
+		nDecalStructure = nStructure;
+	}
+
+	bool PixelGameEngine::Draw(const olc::vi2d& pos, Pixel p)
+	{ return Draw(pos.x, pos.y, p); }
+
+	// This is it, the critical function that plots a pixel
+	bool PixelGameEngine::Draw(int32_t x, int32_t y, Pixel p)
+	{
+		if (!vDrawCommands.empty()) FlushCommandList();
+		if (!pDrawTarget) return false;
+		MarkDrawTargetDirty();
+
+		if (nPixelMode == Pixel::NORMAL)
 		{
 			return pDrawTarget->SetPixel(x, y, p);
 		}
@@ -2045,8 +3026,30 @@ namespace olc
 	{ FillCircle(pos.x, pos.y, radius, p); }
 
 	void PixelGameEngine::FillCircle(int32_t x, int32_t y, int32_t radius, Pixel p)
+	{
+		if (bCommandList && nPixelMode != Pixel::CUSTOM)
+		{
+			if (radius < 0) return;
+			DrawCommand cmd;
+			cmd.type = DrawCommand::Type::FILL_CIRCLE;
+			cmd.nMode = nPixelMode;
+			cmd.col = p;
+			cmd.vPos = { x, y };
+			cmd.vSize = { radius, 0 };
+			cmd.vMin = { x - radius, y - radius };
+			cmd.vMax = { x + radius + 1, y + radius + 1 };
+			RecordCommand(cmd);
+			return;
+		}
+
+		RasterFillCircle(x, y, radius, { 0, 0 }, { GetDrawTargetWidth(), GetDrawTargetHeight() }, p,
+			[this](int32_t px, int32_t py, Pixel c) { Draw(px, py, c); });
+	}
+
+	template<typename F>
+	void PixelGameEngine::RasterFillCircle(int32_t x, int32_t y, int32_t radius, const olc::vi2d& vClipMin, const olc::vi2d& vClipMax, Pixel p, F&& plot)
 	{ // Thanks to IanM-Matrix1 #PR121
-		if (radius < 0 || x < -radius || y < -radius || x - GetDrawTargetWidth() > radius || y - GetDrawTargetHeight() > radius)
+		if (radius < 0 || x < vClipMin.x - radius || y < vClipMin.y - radius || x - vClipMax.x > radius || y - vClipMax.y > radius)
 			return;
 
 		if (radius > 0)
@@ -2057,8 +3060,11 @@ namespace olc
 
 			auto drawline = [&](int sx, int ex, int y)
 			{
+				if (y < vClipMin.y || y >= vClipMax.y) return;
+				sx = std::max(sx, vClipMin.x);
+				ex = std::min(ex, vClipMax.x - 1);
 				for (int x = sx; x <= ex; x++)
-					Draw(x, y, p);
+					plot(x, y, p);
 			};
 
 			while (y0 >= x0)
@@ -2079,8 +3085,8 @@ namespace olc
 				}
 			}
 		}
-		else
-			Draw(x, y, p);
+		else if (x >= vClipMin.x && x < vClipMax.x && y >= vClipMin.y && y < vClipMax.y)
+			plot(x, y, p);
 	}
 
 	void PixelGameEngine::DrawRect(const olc::vi2d& pos, const olc::vi2d& size, Pixel p)
@@ -2096,9 +3102,21 @@ namespace olc
 
 	void PixelGameEngine::Clear(Pixel p)
 	{
+		if (bCommandList)
+		{
+			DrawCommand cmd;
+			cmd.type = DrawCommand::Type::CLEAR;
+			cmd.col = p;
+			cmd.vMin = { 0, 0 };
+			cmd.vMax = { GetDrawTargetWidth(), GetDrawTargetHeight() };
+			RecordCommand(cmd);
+			return;
+		}
+
 		int pixels = GetDrawTargetWidth() * GetDrawTargetHeight();
 		Pixel* m = GetDrawTarget()->GetData();
 		for (int i = 0; i < pixels; i++) m[i] = p;
+		MarkDrawTargetDirty();
 	}
 
 	void PixelGameEngine::ClearBuffer(Pixel p, bool bDepth)
@@ -2146,22 +3164,35 @@ namespace olc
 
 	void PixelGameEngine::FillRect(int32_t x, int32_t y, int32_t w, int32_t h, Pixel p)
 	{
-		int32_t x2 = x + w;
-		int32_t y2 = y + h;
-
-		if (x < 0) x = 0;
-		if (x >= (int32_t)GetDrawTargetWidth()) x = (int32_t)GetDrawTargetWidth();
-		if (y < 0) y = 0;
-		if (y >= (int32_t)GetDrawTargetHeight()) y = (int32_t)GetDrawTargetHeight();
+		if (bCommandList && nPixelMode != Pixel::CUSTOM)
+		{
+			DrawCommand cmd;
+			cmd.type = DrawCommand::Type::FILL_RECT;
+			cmd.nMode = nPixelMode;
+			cmd.col = p;
+			cmd.vPos = { x, y };
+			cmd.vSize = { w, h };
+			cmd.vMin = { x, y };
+			cmd.vMax = { x + w, y + h };
+			RecordCommand(cmd);
+			return;
+		}
 
-		if (x2 < 0) x2 = 0;
-		if (x2 >= (int32_t)GetDrawTargetWidth()) x2 = (int32_t)GetDrawTargetWidth();
-		if (y2 < 0) y2 = 0;
-		if (y2 >= (int32_t)GetDrawTargetHeight()) y2 = (int32_t)GetDrawTargetHeight();
+		RasterFillRect(x, y, w, h, { 0, 0 }, { GetDrawTargetWidth(), GetDrawTargetHeight() }, p,
+			[this](int32_t px, int32_t py, Pixel c) { Draw(px, py, c); });
+	}
 
-		for (int i = x; i < x2; i++)
-			for (int j = y; j < y2; j++)
-				Draw(i, j, p);
+	template<typename F>
+	void PixelGameEngine::RasterFillRect(int32_t x, int32_t y, int32_t w, int32_t h, const olc::vi2d& vClipMin, const olc::vi2d& vClipMax, Pixel p, F&& plot)
+	{
+		int32_t x2 = std::min(x + w, vClipMax.x);
+		int32_t y2 = std::min(y + h, vClipMax.y);
+		x = std::max(x, vClipMin.x);
+		y = std::max(y, vClipMin.y);
+
+		for (int j = y; j < y2; j++)
+			for (int i = x; i < x2; i++)
+				plot(i, j, p);
 	}
 
 	void PixelGameEngine::DrawTriangle(const olc::vi2d& pos1, const olc::vi2d& pos2, const olc::vi2d& pos3, Pixel p)
@@ -2321,33 +3352,7 @@ namespace olc
 		if (sprite == nullptr)
 			return;
 
-		int32_t fxs = 0, fxm = 1, fx = 0;
-		int32_t fys = 0, fym = 1, fy = 0;
-		if (flip & olc::Sprite::Flip::HORIZ) { fxs = sprite->width - 1; fxm = -1; }
-		if (flip & olc::Sprite::Flip::VERT) { fys = sprite->height - 1; fym = -1; }
-
-		if (scale > 1)
-		{
-			fx = fxs;
-			for (int32_t i = 0; i < sprite->width; i++, fx += fxm)
-			{
-				fy = fys;
-				for (int32_t j = 0; j < sprite->height; j++, fy += fym)
-					for (uint32_t is = 0; is < scale; is++)
-						for (uint32_t js = 0; js < scale; js++)
-							Draw(x + (i * scale) + is, y + (j * scale) + js, sprite->GetPixel(fx, fy));
-			}
-		}
-		else
-		{
-			fx = fxs;
-			for (int32_t i = 0; i < sprite->width; i++, fx += fxm)
-			{
-				fy = fys;
-				for (int32_t j = 0; j < sprite->height; j++, fy += fym)
-					Draw(x + i, y + j, sprite->GetPixel(fx, fy));
-			}
-		}
+		DrawPartialSprite(x, y, sprite, 0, 0, sprite->width, sprite->height, scale, flip);
 	}
 
 	void PixelGameEngine::DrawPartialSprite(const olc::vi2d& pos, Sprite* sprite, const olc::vi2d& sourcepos, const olc::vi2d& size, uint32_t scale, uint8_t flip)
@@ -2358,31 +3363,154 @@ namespace olc
 		if (sprite == nullptr)
 			return;
 
-		int32_t fxs = 0, fxm = 1, fx = 0;
-		int32_t fys = 0, fym = 1, fy = 0;
-		if (flip & olc::Sprite::Flip::HORIZ) { fxs = w - 1; fxm = -1; }
-		if (flip & olc::Sprite::Flip::VERT) { fys = h - 1; fym = -1; }
+		// A sprite drawn onto itself reads pixels it has just written, so it is plotted one at a
+		// time in the original order, column by column and each scaled block whole
+		if (sprite == pDrawTarget)
+		{
+			const int32_t s = scale > 1 ? int32_t(scale) : 1;
+			const int32_t fxs = (flip & olc::Sprite::Flip::HORIZ) ? w - 1 : 0, fxm = (flip & olc::Sprite::Flip::HORIZ) ? -1 : 1;
+			const int32_t fys = (flip & olc::Sprite::Flip::VERT) ? h - 1 : 0, fym = (flip & olc::Sprite::Flip::VERT) ? -1 : 1;
+			for (int32_t i = 0, fx = fxs; i < w; i++, fx += fxm)
+				for (int32_t j = 0, fy = fys; j < h; j++, fy += fym)
+					for (int32_t is = 0; is < s; is++)
+						for (int32_t js = 0; js < s; js++)
+							Draw(x + i * s + is, y + j * s + js, sprite->GetPixel(fx + ox, fy + oy));
+			return;
+		}
 
-		if (scale > 1)
+		if (bCommandList && nPixelMode != Pixel::CUSTOM)
+		{
+			const int32_t s = int32_t(std::max(scale, 1u));
+			DrawCommand cmd;
+			cmd.type = DrawCommand::Type::DRAW_SPRITE;
+			cmd.nMode = nPixelMode;
+			cmd.vPos = { x, y };
+			cmd.vSource = { ox, oy };
+			cmd.vSize = { w, h };
+			cmd.nScale = scale;
+			cmd.nFlip = flip;
+			cmd.pSprite = sprite;
+			cmd.vMin = { x, y };
+			cmd.vMax = { x + w * s, y + h * s };
+			RecordCommand(cmd);
+			return;
+		}
+
+		// Areas reaching outside the sprite depend on its sample mode, so go pixel by pixel
+		if (nPixelMode != Pixel::CUSTOM && ox >= 0 && oy >= 0 && ox + w <= sprite->width && oy + h <= sprite->height)
 		{
-			fx = fxs;
-			for (int32_t i = 0; i < w; i++, fx += fxm)
-			{
-				fy = fys;
-				for (int32_t j = 0; j < h; j++, fy += fym)
-					for (uint32_t is = 0; is < scale; is++)
-						for (uint32_t js = 0; js < scale; js++)
-							Draw(x + (i * scale) + is, y + (j * scale) + js, sprite->GetPixel(fx + ox, fy + oy));
-			}
+			BlitSprite(pDrawTarget, x, y, sprite, { ox, oy }, { w, h }, scale, flip, { 0, 0 }, { GetDrawTargetWidth(), GetDrawTargetHeight() }, nPixelMode, fBlendFactor);
+			MarkDrawTargetDirty();
 		}
 		else
+			RasterSprite(x, y, sprite, { ox, oy }, { w, h }, scale, flip, { 0, 0 }, { GetDrawTargetWidth(), GetDrawTargetHeight() },
+				[this](int32_t px, int32_t py, Pixel c) { Draw(px, py, c); });
+	}
+
+	template<typename F>
+	void PixelGameEngine::RasterSprite(int32_t x, int32_t y, const Sprite* sprite, const olc::vi2d& vSource, const olc::vi2d& vSize, uint32_t scale, uint8_t flip, const olc::vi2d& vClipMin, const olc::vi2d& vClipMax, F&& plot)
+	{
+		// A scale of 0 draws at 1:1, as it always has
+		const int32_t s = int32_t(std::max(scale, 1u));
+		const int32_t x2 = std::min(x + vSize.x * s, vClipMax.x);
+		const int32_t y2 = std::min(y + vSize.y * s, vClipMax.y);
+
+		for (int32_t py = std::max(y, vClipMin.y); py < y2; py++)
 		{
-			fx = fxs;
-			for (int32_t i = 0; i < w; i++, fx += fxm)
+			int32_t fy = (py - y) / s;
+			if (flip & olc::Sprite::Flip::VERT) fy = vSize.y - 1 - fy;
+			for (int32_t px = std::max(x, vClipMin.x); px < x2; px++)
 			{
-				fy = fys;
-				for (int32_t j = 0; j < h; j++, fy += fym)
-					Draw(x + i, y + j, sprite->GetPixel(fx + ox, fy + oy));
+				int32_t fx = (px - x) / s;
+				if (flip & olc::Sprite::Flip::HORIZ) fx = vSize.x - 1 - fx;
+				plot(px, py, sprite->GetPixel(fx + vSource.x, fy + vSource.y));
+			}
+		}
+	}
+
+	void PixelGameEngine::BlitSprite(Sprite* target, int32_t x, int32_t y, const Sprite* sprite, const olc::vi2d& vSource, const olc::vi2d& vSize, uint32_t scale, uint8_t flip, const olc::vi2d& vClipMin, const olc::vi2d& vClipMax, Pixel::Mode mode, float fBlend)
+	{
+		if (target == nullptr) return;
+
+		// Clip the destination once, everything below stays inside it
+		const int32_t s = int32_t(std::max(scale, 1u));
+		const int32_t dx1 = std::max(x, vClipMin.x);
+		const int32_t dy1 = std::max(y, vClipMin.y);
+		const int32_t dx2 = std::min(x + vSize.x * s, vClipMax.x);
+		const int32_t dy2 = std::min(y + vSize.y * s, vClipMax.y);
+		if (dx1 >= dx2 || dy1 >= dy2) return;
+
+		const int32_t nWidth = dx2 - dx1;
+		const bool bFlipX = (flip & olc::Sprite::Flip::HORIZ) != 0;
+		const bool bFlipY = (flip & olc::Sprite::Flip::VERT) != 0;
+
+		// Source column of the first visible pixel, and how many more times it repeats
+		const int32_t i0 = (dx1 - x) / s;
+		const int32_t nFirstRun = s - (dx1 - x) % s;
+
+		// Unscaled and unflipped rows are read straight from the sprite, anything else is
+		// expanded into a scanline once per source row and reused for its repeats
+		const bool bDirect = s == 1 && !bFlipX;
+		thread_local std::vector<Pixel> vScanline;
+		if (!bDirect && vScanline.size() < size_t(nWidth)) vScanline.resize(size_t(nWidth));
+
+		const uint32_t nAlphaMask = Pixel(0, 0, 0, 255).n;
+		Pixel* pTarget = target->GetData();
+		const Pixel* pSprite = sprite->pColData.data();
+
+		for (int32_t py = dy1; py < dy2;)
+		{
+			const int32_t j = (py - y) / s;
+			const int32_t fy = bFlipY ? vSize.y - 1 - j : j;
+			const int32_t pyEnd = std::min(y + (j + 1) * s, dy2);
+
+			// Flipping is just a negative stride through the source row
+			const Pixel* pSrcRow = pSprite + size_t(vSource.y + fy) * size_t(sprite->width) + vSource.x;
+			const Pixel* pSrc = pSrcRow + (bFlipX ? vSize.x - 1 - i0 : i0);
+			if (!bDirect)
+			{
+				const int32_t nStride = bFlipX ? -1 : 1;
+				int32_t nRun = nFirstRun;
+				for (int32_t n = 0; n < nWidth; n++)
+				{
+					vScanline[n] = *pSrc;
+					if (--nRun == 0) { pSrc += nStride; nRun = s; }
+				}
+				pSrc = vScanline.data();
+			}
+
+			Pixel* pFirstRow = pTarget + size_t(py) * size_t(target->width) + dx1;
+			for (; py < pyEnd; py++)
+			{
+				Pixel* pDst = pTarget + size_t(py) * size_t(target->width) + dx1;
+				if (mode == Pixel::NORMAL)
+				{
+					// Replicated rows are identical, copy the first one
+					std::memcpy(pDst, pDst == pFirstRow ? pSrc : pFirstRow, size_t(nWidth) * sizeof(Pixel));
+				}
+				else if (mode == Pixel::MASK)
+				{
+					// Branch free so the compiler can vectorise the alpha test
+					uint32_t* d = &pDst->n;
+					const uint32_t* c = &pSrc->n;
+					for (int32_t n = 0; n < nWidth; n++)
+						d[n] = (c[n] & nAlphaMask) == nAlphaMask ? c[n] : d[n];
+				}
+				else if (mode == Pixel::ALPHA)
+				{
+					// Same arithmetic as Draw()
+					for (int32_t n = 0; n < nWidth; n++)
+					{
+						const Pixel p = pSrc[n];
+						const Pixel d = pDst[n];
+						float a = (float)(p.a / 255.0f) * fBlend;
+						float c = 1.0f - a;
+						float r = a * (float)p.r + c * (float)d.r;
+						float g = a * (float)p.g + c * (float)d.g;
+						float b = a * (float)p.b + c * (float)d.b;
+						pDst[n] = Pixel((uint8_t)r, (uint8_t)g, (uint8_t)b);
+					}
+				}
 			}
 		}
 	}
@@ -2393,6 +3521,15 @@ namespace olc
 	void PixelGameEngine::SetDecalStructure(const olc::DecalStructure& structure)
 	{ nDecalStructure = structure; }
 
+	void PixelGameEngine::AllocateDecalGeometry(DecalInstance& di, uint32_t nPoints)
+	{
+		di.points = nPoints;
+		di.pos = arenaDecals.Allocate<olc::vf2d>(nPoints);
+		di.uv = arenaDecals.Allocate<olc::vf2d>(nPoints);
+		di.w = arenaDecals.Allocate<float>(nPoints);
+		di.tint = arenaDecals.Allocate<olc::Pixel>(nPoints);
+	}
+
 	void PixelGameEngine::DrawPartialDecal(const olc::vf2d& pos, olc::Decal* decal, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::vf2d& scale, const olc::Pixel& tint)
 	{
 		olc::vf2d vScreenSpacePos =
@@ -2413,14 +3550,14 @@ namespace olc
 		olc::vf2d vQuantisedDim = ((vScreenSpaceDim * vWindow) + olc::vf2d(0.5f, -0.5f)).ceil() / vWindow;
 
 		DecalInstance di;
-		di.points = 4;
+		AllocateDecalGeometry(di, 4);
 		di.decal = decal;
-		di.tint = { tint, tint, tint, tint };
-		di.pos = { { vQuantisedPos.x, vQuantisedPos.y }, { vQuantisedPos.x, vQuantisedDim.y }, { vQuantisedDim.x, vQuantisedDim.y }, { vQuantisedDim.x, vQuantisedPos.y } };
+		SetDecalPoints(di.tint, { tint, tint, tint, tint });
+		SetDecalPoints(di.pos, { { vQuantisedPos.x, vQuantisedPos.y }, { vQuantisedPos.x, vQuantisedDim.y }, { vQuantisedDim.x, vQuantisedDim.y }, { vQuantisedDim.x, vQuantisedPos.y } });
 		olc::vf2d uvtl = (source_pos + olc::vf2d(0.0001f, 0.0001f)) * decal->vUVScale;
 		olc::vf2d uvbr = (source_pos + source_size - olc::vf2d(0.0001f, 0.0001f)) * decal->vUVScale;
-		di.uv = { { uvtl.x, uvtl.y }, { uvtl.x, uvbr.y }, { uvbr.x, uvbr.y }, { uvbr.x, uvtl.y } };
-		di.w = { 1,1,1,1 };
+		SetDecalPoints(di.uv, { { uvtl.x, uvtl.y }, { uvtl.x, uvbr.y }, { uvbr.x, uvbr.y }, { uvbr.x, uvtl.y } });
+		SetDecalPoints(di.w, { 1,1,1,1 });
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
 		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
@@ -2441,14 +3578,14 @@ namespace olc
 		};
 
 		DecalInstance di;
-		di.points = 4;
+		AllocateDecalGeometry(di, 4);
 		di.decal = decal;
-		di.tint = { tint, tint, tint, tint };
-		di.pos = { { vScreenSpacePos.x, vScreenSpacePos.y }, { vScreenSpacePos.x, vScreenSpaceDim.y }, { vScreenSpaceDim.x, vScreenSpaceDim.y }, { vScreenSpaceDim.x, vScreenSpacePos.y } };
+		SetDecalPoints(di.tint, { tint, tint, tint, tint });
+		SetDecalPoints(di.pos, { { vScreenSpacePos.x, vScreenSpacePos.y }, { vScreenSpacePos.x, vScreenSpaceDim.y }, { vScreenSpaceDim.x, vScreenSpaceDim.y }, { vScreenSpaceDim.x, vScreenSpacePos.y } });
 		olc::vf2d uvtl = (source_pos) * decal->vUVScale;
 		olc::vf2d uvbr = uvtl + ((source_size) * decal->vUVScale);
-		di.uv = { { uvtl.x, uvtl.y }, { uvtl.x, uvbr.y }, { uvbr.x, uvbr.y }, { uvbr.x, uvtl.y } };
-		di.w = { 1,1,1,1 };
+		SetDecalPoints(di.uv, { { uvtl.x, uvtl.y }, { uvtl.x, uvbr.y }, { uvbr.x, uvbr.y }, { uvbr.x, uvtl.y } });
+		SetDecalPoints(di.w, { 1,1,1,1 });
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
 		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
@@ -2470,12 +3607,12 @@ namespace olc
 		};
 
 		DecalInstance di;
+		AllocateDecalGeometry(di, 4);
 		di.decal = decal;
-		di.points = 4;
-		di.tint = { tint, tint, tint, tint };
-		di.pos = { { vScreenSpacePos.x, vScreenSpacePos.y }, { vScreenSpacePos.x, vScreenSpaceDim.y }, { vScreenSpaceDim.x, vScreenSpaceDim.y }, { vScreenSpaceDim.x, vScreenSpacePos.y } };
-		di.uv = { { 0.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}, {1.0f, 0.0f} };
-		di.w = { 1, 1, 1, 1 };
+		SetDecalPoints(di.tint, { tint, tint, tint, tint });
+		SetDecalPoints(di.pos, { { vScreenSpacePos.x, vScreenSpacePos.y }, { vScreenSpacePos.x, vScreenSpaceDim.y }, { vScreenSpaceDim.x, vScreenSpaceDim.y }, { vScreenSpaceDim.x, vScreenSpacePos.y } });
+		SetDecalPoints(di.uv, { { 0.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}, {1.0f, 0.0f} });
+		SetDecalPoints(di.w, { 1, 1, 1, 1 });
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
 		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
@@ -2485,11 +3622,7 @@ namespace olc
 	{
 		DecalInstance di;
 		di.decal = decal;
-		di.pos.resize(elements);
-		di.uv.resize(elements);
-		di.w.resize(elements);
-		di.tint.resize(elements);
-		di.points = elements;
+		AllocateDecalGeometry(di, elements);
 		for (uint32_t i = 0; i < elements; i++)
 		{
 			di.pos[i] = { (pos[i].x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos[i].y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
@@ -2506,11 +3639,7 @@ namespace olc
 	{
 		DecalInstance di;
 		di.decal = decal;
-		di.points = uint32_t(pos.size());
-		di.pos.resize(di.points);
-		di.uv.resize(di.points);
-		di.w.resize(di.points);
-		di.tint.resize(di.points);
+		AllocateDecalGeometry(di, uint32_t(pos.size()));
 		for (uint32_t i = 0; i < di.points; i++)
 		{
 			di.pos[i] = { (pos[i].x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos[i].y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
@@ -2527,11 +3656,7 @@ namespace olc
 	{
 		DecalInstance di;
 		di.decal = decal;
-		di.points = uint32_t(pos.size());
-		di.pos.resize(di.points);
-		di.uv.resize(di.points);
-		di.w.resize(di.points);
-		di.tint.resize(di.points);
+		AllocateDecalGeometry(di, uint32_t(pos.size()));
 		for (uint32_t i = 0; i < di.points; i++)
 		{
 			di.pos[i] = { (pos[i].x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos[i].y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
@@ -2548,11 +3673,7 @@ namespace olc
 	{
 		DecalInstance di;
 		di.decal = decal;
-		di.points = uint32_t(pos.size());
-		di.pos.resize(di.points);
-		di.uv.resize(di.points);
-		di.w.resize(di.points);
-		di.tint.resize(di.points);
+		AllocateDecalGeometry(di, uint32_t(pos.size()));
 		for (uint32_t i = 0; i < di.points; i++)
 		{
 			di.pos[i] = { (pos[i].x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos[i].y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
@@ -2571,11 +3692,7 @@ namespace olc
 	{
 		DecalInstance di;
 		di.decal = decal;
-		di.points = uint32_t(pos.size());
-		di.pos.resize(di.points);
-		di.uv.resize(di.points);
-		di.w.resize(di.points);
-		di.tint.resize(di.points);
+		AllocateDecalGeometry(di, uint32_t(pos.size()));
 		for (uint32_t i = 0; i < di.points; i++)
 		{
 			di.pos[i] = { pos[i][0], pos[i][1] };
@@ -2592,11 +3709,7 @@ namespace olc
 	{
 		DecalInstance di;
 		di.decal = nullptr;
-		di.points = uint32_t(2);
-		di.pos.resize(di.points);
-		di.uv.resize(di.points);
-		di.w.resize(di.points);
-		di.tint.resize(di.points);
+		AllocateDecalGeometry(di, 2);
 		di.pos[0] = { (pos1.x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos1.y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
 		di.uv[0] = { 0.0f, 0.0f };
 		di.tint[0] = p;
@@ -2629,12 +3742,11 @@ namespace olc
 	void PixelGameEngine::DrawRotatedDecal(const olc::vf2d& pos, olc::Decal* decal, const float fAngle, const olc::vf2d& center, const olc::vf2d& scale, const olc::Pixel& tint)
 	{
 		DecalInstance di;
+		AllocateDecalGeometry(di, 4);
 		di.decal = decal;
-		di.pos.resize(4);
-		di.uv = { { 0.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}, {1.0f, 0.0f} };
-		di.w = { 1, 1, 1, 1 };
-		di.tint = { tint, tint, tint, tint };
-		di.points = 4;
+		SetDecalPoints(di.uv, { { 0.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}, {1.0f, 0.0f} });
+		SetDecalPoints(di.w, { 1, 1, 1, 1 });
+		SetDecalPoints(di.tint, { tint, tint, tint, tint });
 		di.pos[0] = (olc::vf2d(0.0f, 0.0f) - center) * scale;
 		di.pos[1] = (olc::vf2d(0.0f, float(decal->sprite->height)) - center) * scale;
 		di.pos[2] = (olc::vf2d(float(decal->sprite->width), float(decal->sprite->height)) - center) * scale;
@@ -2656,11 +3768,10 @@ namespace olc
 	void PixelGameEngine::DrawPartialRotatedDecal(const olc::vf2d& pos, olc::Decal* decal, const float fAngle, const olc::vf2d& center, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::vf2d& scale, const olc::Pixel& tint)
 	{
 		DecalInstance di;
+		AllocateDecalGeometry(di, 4);
 		di.decal = decal;
-		di.points = 4;
-		di.tint = { tint, tint, tint, tint };
-		di.w = { 1, 1, 1, 1 };
-		di.pos.resize(4);
+		SetDecalPoints(di.tint, { tint, tint, tint, tint });
+		SetDecalPoints(di.w, { 1, 1, 1, 1 });
 		di.pos[0] = (olc::vf2d(0.0f, 0.0f) - center) * scale;
 		di.pos[1] = (olc::vf2d(0.0f, source_size.y) - center) * scale;
 		di.pos[2] = (olc::vf2d(source_size.x, source_size.y) - center) * scale;
@@ -2675,7 +3786,7 @@ namespace olc
 
 		olc::vf2d uvtl = source_pos * decal->vUVScale;
 		olc::vf2d uvbr = uvtl + (source_size * decal->vUVScale);
-		di.uv = { { uvtl.x, uvtl.y }, { uvtl.x, uvbr.y }, { uvbr.x, uvbr.y }, { uvbr.x, uvtl.y } };
+		SetDecalPoints(di.uv, { { uvtl.x, uvtl.y }, { uvtl.x, uvbr.y }, { uvbr.x, uvbr.y }, { uvbr.x, uvtl.y } });
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
 		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
@@ -2684,19 +3795,18 @@ namespace olc
 	void PixelGameEngine::DrawPartialWarpedDecal(olc::Decal* decal, const olc::vf2d* pos, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::Pixel& tint)
 	{
 		DecalInstance di;
-		di.points = 4;
+		AllocateDecalGeometry(di, 4);
 		di.decal = decal;
-		di.tint = { tint, tint, tint, tint };
-		di.w = { 1, 1, 1, 1 };
-		di.pos.resize(4);
-		di.uv = { { 0.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}, {1.0f, 0.0f} };
+		SetDecalPoints(di.tint, { tint, tint, tint, tint });
+		SetDecalPoints(di.w, { 1, 1, 1, 1 });
+		SetDecalPoints(di.uv, { { 0.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}, {1.0f, 0.0f} });
 		olc::vf2d center;
 		float rd = ((pos[2].x - pos[0].x) * (pos[3].y - pos[1].y) - (pos[3].x - pos[1].x) * (pos[2].y - pos[0].y));
 		if (rd != 0)
 		{
 			olc::vf2d uvtl = source_pos * decal->vUVScale;
 			olc::vf2d uvbr = uvtl + (source_size * decal->vUVScale);
-			di.uv = { { uvtl.x, uvtl.y }, { uvtl.x, uvbr.y }, { uvbr.x, uvbr.y }, { uvbr.x, uvtl.y } };
+			SetDecalPoints(di.uv, { { uvtl.x, uvtl.y }, { uvtl.x, uvbr.y }, { uvbr.x, uvbr.y }, { uvbr.x, uvtl.y } });
 
 			rd = 1.0f / rd;
 			float rn = ((pos[3].x - pos[1].x) * (pos[0].y - pos[1].y) - (pos[3].y - pos[1].y) * (pos[0].x - pos[1].x)) * rd;
@@ -2720,12 +3830,11 @@ namespace olc
 		// Thanks Nathan Reed, a brilliant article explaining whats going on here
 		// http://www.reedbeta.com/blog/quadrilateral-interpolation-part-1/
 		DecalInstance di;
-		di.points = 4;
+		AllocateDecalGeometry(di, 4);
 		di.decal = decal;
-		di.tint = { tint, tint, tint, tint };
-		di.w = { 1, 1, 1, 1 };
-		di.pos.resize(4);
-		di.uv = { { 0.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}, {1.0f, 0.0f} };
+		SetDecalPoints(di.tint, { tint, tint, tint, tint });
+		SetDecalPoints(di.w, { 1, 1, 1, 1 });
+		SetDecalPoints(di.uv, { { 0.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}, {1.0f, 0.0f} });
 		olc::vf2d center;
 		float rd = ((pos[2].x - pos[0].x) * (pos[3].y - pos[1].y) - (pos[3].x - pos[1].x) * (pos[2].y - pos[0].y));
 		if (rd != 0)
@@ -2851,7 +3960,7 @@ namespace olc
 		}
 	}
 
-	olc::vi2d PixelGameEngine::GetTextSize(const std::string& s)
+	olc::vi2d PixelGameEngine::GetTextSize(std::string_view s)
 	{
 		olc::vi2d size = { 0,1 };
 		olc::vi2d pos = { 0,1 };
@@ -2866,22 +3975,56 @@ namespace olc
 		return size * 8;
 	}
 
-	void PixelGameEngine::DrawString(const olc::vi2d& pos, const std::string& sText, Pixel col, uint32_t scale)
+	void PixelGameEngine::DrawString(const olc::vi2d& pos, std::string_view sText, Pixel col, uint32_t scale)
 	{ DrawString(pos.x, pos.y, sText, col, scale); }
 
-	void PixelGameEngine::DrawString(int32_t x, int32_t y, const std::string& sText, Pixel col, uint32_t scale)
+	void PixelGameEngine::DrawString(int32_t x, int32_t y, std::string_view sText, Pixel col, uint32_t scale)
 	{
-		int32_t sx = 0;
-		int32_t sy = 0;
+		OLC_PROFILE_ZONE("text");
 		Pixel::Mode m = nPixelMode;
+		if (bCommandList && m != Pixel::CUSTOM)
+		{
+			DrawCommand cmd;
+			cmd.type = DrawCommand::Type::DRAW_STRING;
+			cmd.nMode = col.a != 255 ? Pixel::ALPHA : Pixel::MASK;
+			cmd.col = col;
+			cmd.vPos = { x, y };
+			cmd.nScale = scale;
+			cmd.nTextOffset = uint32_t(sCommandText.size());
+			cmd.nTextLength = uint32_t(sText.size());
+			sCommandText += sText;
+			cmd.vMin = { x, y };
+			cmd.vMax = cmd.vMin + GetTextSize(sText) * int32_t(std::max(scale, 1u));
+			RecordCommand(cmd);
+			return;
+		}
+
 		// Thanks @tucna, spotted bug with col.ALPHA :P
 		if (m != Pixel::CUSTOM) // Thanks @Megarev, required for "shaders"
 		{
 			if (col.a != 255)		SetPixelMode(Pixel::ALPHA);
 			else					SetPixelMode(Pixel::MASK);
 		}
-		for (auto c : sText)
+		RasterString(x, y, sText.data(), sText.size(), scale, { 0, 0 }, { GetDrawTargetWidth(), GetDrawTargetHeight() }, col,
+			[this](int32_t px, int32_t py, Pixel c) { Draw(px, py, c); });
+		SetPixelMode(m);
+	}
+
+	template<typename F>
+	void PixelGameEngine::RasterString(int32_t x, int32_t y, const char* sText, size_t nLength, uint32_t scale, const olc::vi2d& vClipMin, const olc::vi2d& vClipMax, Pixel col, F&& plot)
+	{
+		auto clipped = [&](int32_t px, int32_t py)
+		{
+			if (px >= vClipMin.x && px < vClipMax.x && py >= vClipMin.y && py < vClipMax.y)
+				plot(px, py, col);
+		};
+
+		int32_t sx = 0;
+		int32_t sy = 0;
+		const int32_t nGlyph = 8 * int32_t(std::max(scale, 1u));
+		for (size_t n = 0; n < nLength; n++)
 		{
+			const char c = sText[n];
 			if (c == '\n')
 			{
 				sx = 0; sy += 8 * scale;
@@ -2890,31 +4033,35 @@ namespace olc
 			{
 				sx += 8 * nTabSizeInSpaces * scale;
 			}
-			else			
+			else
 			{
-				int32_t ox = (c - 32) % 16;
-				int32_t oy = (c - 32) / 16;
-
-				if (scale > 1)
+				// Skip glyphs that lie wholly outside the clip window
+				const int32_t gx = x + sx, gy = y + sy;
+				if (gx < vClipMax.x && gy < vClipMax.y && gx + nGlyph > vClipMin.x && gy + nGlyph > vClipMin.y)
 				{
-					for (uint32_t i = 0; i < 8; i++)
-						for (uint32_t j = 0; j < 8; j++)
-							if (fontSprite->GetPixel(i + ox * 8, j + oy * 8).r > 0)
-								for (uint32_t is = 0; is < scale; is++)
-									for (uint32_t js = 0; js < scale; js++)
-										Draw(x + sx + (i * scale) + is, y + sy + (j * scale) + js, col);
-				}
-				else
-				{
-					for (uint32_t i = 0; i < 8; i++)
-						for (uint32_t j = 0; j < 8; j++)
-							if (fontSprite->GetPixel(i + ox * 8, j + oy * 8).r > 0)
-								Draw(x + sx + i, y + sy + j, col);
+					int32_t ox = (c - 32) % 16;
+					int32_t oy = (c - 32) / 16;
+
+					if (scale > 1)
+					{
+						for (uint32_t i = 0; i < 8; i++)
+							for (uint32_t j = 0; j < 8; j++)
+								if (fontSprite->GetPixel(i + ox * 8, j + oy * 8).r > 0)
+									for (uint32_t is = 0; is < scale; is++)
+										for (uint32_t js = 0; js < scale; js++)
+											clipped(gx + (i * scale) + is, gy + (j * scale) + js);
+					}
+					else
+					{
+						for (uint32_t i = 0; i < 8; i++)
+							for (uint32_t j = 0; j < 8; j++)
+								if (fontSprite->GetPixel(i + ox * 8, j + oy * 8).r > 0)
+									clipped(gx + i, gy + j);
+					}
 				}
 				sx += 8 * scale;
 			}
 		}
-		SetPixelMode(m);
 	}
 
 	olc::vi2d PixelGameEngine::GetTextSizeProp(const std::string& s)
@@ -3004,6 +4151,157 @@ namespace olc
 		if (fBlendFactor > 1.0f) fBlendFactor = 1.0f;
 	}
 
+	void PixelGameEngine::SetFrameRateLimit(float fMaxFPS)
+	{
+		fFrameRateLimit = std::max(fMaxFPS, 0.0f);
+		tpNextFrame = std::chrono::steady_clock::now();
+	}
+
+	void PixelGameEngine::SetFixedTimestep(float fStep, uint32_t nMaxTicks)
+	{
+		fFixedStep = std::max(fStep, 0.0f);
+		nFixedMaxTicks = std::max(nMaxTicks, 1u);
+		fFixedAccumulator = 0.0f;
+		fFixedAlpha = 1.0f;
+	}
+
+	void PixelGameEngine::EnableIdleMode(bool bEnable)
+	{
+		bIdleMode = bEnable;
+		RequestFrame();
+	}
+
+	void PixelGameEngine::RequestFrame()
+	{
+		{
+			std::lock_guard<std::mutex> lock(muxIdle);
+			bFrameRequested = true;
+		}
+		cvIdle.notify_one();
+	}
+
+	void PixelGameEngine::SkipFrame()
+	{
+#if !defined(OLC_PLATFORM_HEADLESS)
+		bSkipFrame = true;
+#endif
+		// Offscreen runs capture every frame, the untouched layers are simply shown again
+	}
+
+	void PixelGameEngine::EnableCommandList(bool bEnable, uint32_t nThreads, int32_t nTileSize)
+	{
+		FlushCommandList();
+		bCommandList = bEnable;
+		nCommandTileSize = std::max(nTileSize, 8);
+		if (nThreads == 0) nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		// The engine thread rasterises tiles too, so needs one less helper
+		poolRaster.Start(bEnable ? nThreads - 1 : 0);
+	}
+
+	void PixelGameEngine::RecordCommand(DrawCommand& cmd)
+	{
+		cmd.fBlend = fBlendFactor;
+		vDrawCommands.push_back(cmd);
+	}
+
+	void PixelGameEngine::FlushCommandList()
+	{
+		if (vDrawCommands.empty()) return;
+		OLC_PROFILE_ZONE("command list");
+
+		if (pDrawTarget != nullptr)
+		{
+			MarkDrawTargetDirty();
+			const olc::vi2d vTarget = { pDrawTarget->width, pDrawTarget->height };
+			const olc::vi2d vTiles = (vTarget + olc::vi2d(nCommandTileSize - 1, nCommandTileSize - 1)) / nCommandTileSize;
+			vCommandTiles.resize(size_t(vTiles.x) * size_t(vTiles.y));
+			for (auto& tile : vCommandTiles) tile.clear();
+
+			// Bin each command into every tile it may touch, tiles keep recording order
+			// so overlapping blends resolve exactly as they would immediately
+			for (uint32_t i = 0; i < uint32_t(vDrawCommands.size()); i++)
+			{
+				const olc::vi2d vMin = vDrawCommands[i].vMin.max({ 0, 0 });
+				const olc::vi2d vMax = vDrawCommands[i].vMax.min(vTarget);
+				if (vMin.x >= vMax.x || vMin.y >= vMax.y) continue;
+
+				const olc::vi2d vTileMin = vMin / nCommandTileSize;
+				const olc::vi2d vTileMax = (vMax - olc::vi2d(1, 1)) / nCommandTileSize;
+				for (int32_t ty = vTileMin.y; ty <= vTileMax.y; ty++)
+					for (int32_t tx = vTileMin.x; tx <= vTileMax.x; tx++)
+						vCommandTiles[size_t(ty) * size_t(vTiles.x) + size_t(tx)].push_back(i);
+			}
+
+			poolRaster.Run(uint32_t(vCommandTiles.size()), [&](uint32_t nTile)
+			{
+				const olc::vi2d vClipMin = olc::vi2d(int32_t(nTile) % vTiles.x, int32_t(nTile) / vTiles.x) * nCommandTileSize;
+				const olc::vi2d vClipMax = (vClipMin + olc::vi2d(nCommandTileSize, nCommandTileSize)).min(vTarget);
+				for (uint32_t i : vCommandTiles[nTile])
+					ExecuteCommand(vDrawCommands[i], vClipMin, vClipMax);
+			});
+		}
+
+		vDrawCommands.clear();
+		sCommandText.clear();
+	}
+
+	void PixelGameEngine::ExecuteCommand(const DrawCommand& cmd, const olc::vi2d& vClipMin, const olc::vi2d& vClipMax)
+	{
+		Pixel* pData = pDrawTarget->GetData();
+		const int32_t nWidth = pDrawTarget->width;
+
+		if (cmd.type == DrawCommand::Type::CLEAR)
+		{
+			for (int32_t y = vClipMin.y; y < vClipMax.y; y++)
+				std::fill(pData + y * nWidth + vClipMin.x, pData + y * nWidth + vClipMax.x, cmd.col);
+			return;
+		}
+
+		// Blends exactly as Draw() does, the clip window is always inside the target
+		const Pixel::Mode nMode = cmd.nMode;
+		const float fBlend = cmd.fBlend;
+		auto plot = [&](int32_t x, int32_t y, Pixel p)
+		{
+			Pixel& d = pData[y * nWidth + x];
+			if (nMode == Pixel::NORMAL)
+				d = p;
+			else if (nMode == Pixel::MASK)
+			{
+				if (p.a == 255) d = p;
+			}
+			else if (nMode == Pixel::ALPHA)
+			{
+				float a = (float)(p.a / 255.0f) * fBlend;
+				float c = 1.0f - a;
+				float r = a * (float)p.r + c * (float)d.r;
+				float g = a * (float)p.g + c * (float)d.g;
+				float b = a * (float)p.b + c * (float)d.b;
+				d = Pixel((uint8_t)r, (uint8_t)g, (uint8_t)b);
+			}
+		};
+
+		switch (cmd.type)
+		{
+		case DrawCommand::Type::FILL_RECT:
+			RasterFillRect(cmd.vPos.x, cmd.vPos.y, cmd.vSize.x, cmd.vSize.y, vClipMin, vClipMax, cmd.col, plot);
+			break;
+		case DrawCommand::Type::FILL_CIRCLE:
+			RasterFillCircle(cmd.vPos.x, cmd.vPos.y, cmd.vSize.x, vClipMin, vClipMax, cmd.col, plot);
+			break;
+		case DrawCommand::Type::DRAW_STRING:
+			RasterString(cmd.vPos.x, cmd.vPos.y, sCommandText.data() + cmd.nTextOffset, cmd.nTextLength, cmd.nScale, vClipMin, vClipMax, cmd.col, plot);
+			break;
+		case DrawCommand::Type::DRAW_SPRITE:
+			if (cmd.vSource.x >= 0 && cmd.vSource.y >= 0 && cmd.vSource.x + cmd.vSize.x <= cmd.pSprite->width && cmd.vSource.y + cmd.vSize.y <= cmd.pSprite->height)
+				BlitSprite(pDrawTarget, cmd.vPos.x, cmd.vPos.y, cmd.pSprite, cmd.vSource, cmd.vSize, cmd.nScale, cmd.nFlip, vClipMin, vClipMax, cmd.nMode, cmd.fBlend);
+			else
+				RasterSprite(cmd.vPos.x, cmd.vPos.y, cmd.pSprite, cmd.vSource, cmd.vSize, cmd.nScale, cmd.nFlip, vClipMin, vClipMax, plot);
+			break;
+		default:
+			break;
+		}
+	}
+
 	// User must override these functions as required. I have not made
 	// them abstract because I do need a default behaviour to occur if
 	// they are not overwritten
@@ -3016,6 +4314,9 @@ namespace olc
 
 	bool PixelGameEngine::OnUserDestroy()
 	{ return true; }
+
+	bool PixelGameEngine::OnFixedUpdate(float fStep)
+	{ UNUSED(fStep); return true; }
 	
 	void PixelGameEngine::olc_UpdateViewport()
 	{
@@ -3047,10 +4348,15 @@ namespace olc
 	{
 		vWindowSize = { x, y };
 		olc_UpdateViewport();
+		bForcePresent = true;
+		NotifyInput();
 	}
 
 	void PixelGameEngine::olc_UpdateMouseWheel(int32_t delta)
-	{ nMouseWheelDeltaCache += delta; }
+	{
+		nMouseWheelDeltaCache += delta;
+		NotifyInput();
+	}
 
 	void PixelGameEngine::olc_UpdateMouse(int32_t x, int32_t y)
 	{
@@ -3067,19 +4373,20 @@ namespace olc
 		if (vMousePosCache.y >= (int32_t)vScreenSize.y)	vMousePosCache.y = vScreenSize.y - 1;
 		if (vMousePosCache.x < 0) vMousePosCache.x = 0;
 		if (vMousePosCache.y < 0) vMousePosCache.y = 0;
+		NotifyInput();
 	}
 
 	void PixelGameEngine::olc_UpdateMouseState(int32_t button, bool state)
-	{ pMouseNewState[button] = state; }
+	{ pMouseNewState[button] = state; NotifyInput(); }
 
 	void PixelGameEngine::olc_UpdateKeyState(int32_t key, bool state)
-	{ pKeyNewState[key] = state; }
+	{ pKeyNewState[key] = state; NotifyInput(); }
 
 	void PixelGameEngine::olc_UpdateMouseFocus(bool state)
-	{ bHasMouseFocus = state; }
+	{ bHasMouseFocus = state; NotifyInput(); }
 
 	void PixelGameEngine::olc_UpdateKeyFocus(bool state)
-	{ bHasInputFocus = state; }
+	{ bHasInputFocus = state; NotifyInput(); }
 
 	void PixelGameEngine::olc_Reanimate()
 	{ bAtomActive = true; }
@@ -3088,7 +4395,162 @@ namespace olc
 	{ return bAtomActive; }
 
 	void PixelGameEngine::olc_Terminate()
-	{ bAtomActive = false; }
+	{
+		bAtomActive = false;
+		NotifyInput();
+	}
+
+	void PixelGameEngine::NotifyInput()
+	{
+		{
+			// Incremented under the lock so a sleeping engine thread cannot miss it
+			std::lock_guard<std::mutex> lock(muxIdle);
+			nInputEvents++;
+		}
+		cvIdle.notify_one();
+	}
+
+	// Input recordings are "OLCINPUT", a uint32_t version, then one record per frame:
+	//   uint8_t  flags     1 = mouse moved, 2 = wheel moved
+	//   float    fElapsedTime
+	//   int32_t  x, y      if the mouse moved
+	//   int32_t  delta     if the wheel moved
+	//   uint16_t n, then n uint16_t state changes: key code, or 256 + mouse button,
+	//            with the top bit set for down
+	// Everything is little endian, as written by the machines we run on
+	static const char sInputMagic[8] = { 'O', 'L', 'C', 'I', 'N', 'P', 'U', 'T' };
+	static const uint32_t nInputVersion = 1;
+
+	olc::rcode PixelGameEngine::RecordInput(const std::string& sFile)
+	{
+		ofsInputRecord.open(sFile, std::ios::binary);
+		if (!ofsInputRecord.is_open()) return olc::FAIL;
+		ofsInputRecord.write(sInputMagic, sizeof(sInputMagic));
+		ofsInputRecord.write((const char*)&nInputVersion, sizeof(nInputVersion));
+		std::fill(std::begin(pKeyLogged), std::end(pKeyLogged), false);
+		std::fill(std::begin(pMouseLogged), std::end(pMouseLogged), false);
+		vMouseLogged = { 0, 0 };
+		return ofsInputRecord.good() ? olc::OK : olc::FAIL;
+	}
+
+	olc::rcode PixelGameEngine::ReplayInput(const std::string& sFile, float fFixedStep)
+	{
+		std::ifstream ifs(sFile, std::ios::binary);
+		if (!ifs.is_open()) return olc::NO_FILE;
+		vInputReplay.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+
+		const size_t nHeader = sizeof(sInputMagic) + sizeof(nInputVersion);
+		uint32_t nVersion = 0;
+		if (vInputReplay.size() < nHeader || std::memcmp(vInputReplay.data(), sInputMagic, sizeof(sInputMagic)) != 0)
+			return olc::FAIL;
+		std::memcpy(&nVersion, vInputReplay.data() + sizeof(sInputMagic), sizeof(nVersion));
+		if (nVersion != nInputVersion) return olc::FAIL;
+
+		nInputReplayNext = nHeader;
+		bInputReplay = true;
+		fInputReplayStep = fFixedStep;
+		std::fill(std::begin(pKeyLogged), std::end(pKeyLogged), false);
+		std::fill(std::begin(pMouseLogged), std::end(pMouseLogged), false);
+		vMouseLogged = { 0, 0 };
+		return olc::OK;
+	}
+
+	void PixelGameEngine::RecordInputFrame(float fElapsedTime)
+	{
+		uint16_t vChanges[256 + nMouseButtons];
+		uint16_t nChanges = 0;
+		for (uint16_t i = 0; i < 256; i++)
+			if (pKeyNewState[i] != pKeyLogged[i])
+			{
+				pKeyLogged[i] = pKeyNewState[i];
+				vChanges[nChanges++] = i | (pKeyLogged[i] ? 0x8000 : 0);
+			}
+		for (uint16_t i = 0; i < nMouseButtons; i++)
+			if (pMouseNewState[i] != pMouseLogged[i])
+			{
+				pMouseLogged[i] = pMouseNewState[i];
+				vChanges[nChanges++] = (256 + i) | (pMouseLogged[i] ? 0x8000 : 0);
+			}
+
+		const uint8_t nFlags = (vMousePos != vMouseLogged ? 1 : 0) | (nMouseWheelDelta != 0 ? 2 : 0);
+		ofsInputRecord.write((const char*)&nFlags, sizeof(nFlags));
+		ofsInputRecord.write((const char*)&fElapsedTime, sizeof(fElapsedTime));
+		if (nFlags & 1)
+		{
+			ofsInputRecord.write((const char*)&vMousePos.x, sizeof(int32_t));
+			ofsInputRecord.write((const char*)&vMousePos.y, sizeof(int32_t));
+			vMouseLogged = vMousePos;
+		}
+		if (nFlags & 2) ofsInputRecord.write((const char*)&nMouseWheelDelta, sizeof(int32_t));
+		ofsInputRecord.write((const char*)&nChanges, sizeof(nChanges));
+		ofsInputRecord.write((const char*)vChanges, nChanges * sizeof(uint16_t));
+	}
+
+	bool PixelGameEngine::ReplayInputFrame(float& fElapsedTime)
+	{
+		auto Read = [this](void* p, size_t nSize)
+		{
+			if (vInputReplay.size() - nInputReplayNext < nSize) return false;
+			std::memcpy(p, vInputReplay.data() + nInputReplayNext, nSize);
+			nInputReplayNext += nSize;
+			return true;
+		};
+
+		uint8_t nFlags = 0;
+		float fRecorded = 0.0f;
+		int32_t nWheel = 0;
+		uint16_t nChanges = 0;
+		if (!Read(&nFlags, sizeof(nFlags)) || !Read(&fRecorded, sizeof(fRecorded))) return false;
+		if ((nFlags & 1) && (!Read(&vMouseLogged.x, sizeof(int32_t)) || !Read(&vMouseLogged.y, sizeof(int32_t)))) return false;
+		if ((nFlags & 2) && !Read(&nWheel, sizeof(nWheel))) return false;
+		if (!Read(&nChanges, sizeof(nChanges))) return false;
+		for (uint16_t i = 0; i < nChanges; i++)
+		{
+			uint16_t nChange = 0;
+			if (!Read(&nChange, sizeof(nChange))) return false;
+			const uint16_t nCode = nChange & 0x7FFF;
+			if (nCode < 256) pKeyLogged[nCode] = (nChange & 0x8000) != 0;
+			else if (nCode < 256 + nMouseButtons) pMouseLogged[nCode - 256] = (nChange & 0x8000) != 0;
+		}
+
+		std::copy(std::begin(pKeyLogged), std::end(pKeyLogged), pKeyNewState);
+		std::copy(std::begin(pMouseLogged), std::end(pMouseLogged), pMouseNewState);
+		vMousePosCache = vMouseLogged;
+		nMouseWheelDeltaCache = nWheel;
+		fElapsedTime = fInputReplayStep > 0.0f ? fInputReplayStep : fRecorded;
+		fLastElapsed = fElapsedTime;
+		return true;
+	}
+
+	void PixelGameEngine::PaceFrame()
+	{
+		if (fFrameRateLimit > 0.0f)
+		{
+			const auto tpPeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / double(fFrameRateLimit)));
+			auto tpNow = std::chrono::steady_clock::now();
+			tpNextFrame += tpPeriod;
+
+			// Running behind, start again from now rather than rushing to catch up
+			if (tpNextFrame < tpNow - tpPeriod) tpNextFrame = tpNow;
+
+			// Schedulers wake sleepers late, so sleep until just short of the deadline
+			// and yield through the remainder
+			const auto tpSpin = std::chrono::microseconds(1500);
+			if (tpNextFrame - tpNow > tpSpin)
+				std::this_thread::sleep_until(tpNextFrame - tpSpin);
+			while (std::chrono::steady_clock::now() < tpNextFrame)
+				std::this_thread::yield();
+		}
+
+		if (bIdleMode && !bInputReplay)
+		{
+			// Platforms that deliver events on other threads wake us straight away, the
+			// rest gather them in HandleSystemEvent, so look again every few milliseconds
+			std::unique_lock<std::mutex> lock(muxIdle);
+			cvIdle.wait_for(lock, std::chrono::milliseconds(10), [this]
+			{ return bFrameRequested || nInputEvents != nInputEventsSeen || !bAtomActive; });
+		}
+	}
 
 	void PixelGameEngine::EngineThread()
 	{
@@ -3106,8 +4568,8 @@ namespace olc
 
 		while (bAtomActive)
 		{
-			// Run as fast as possible
-			while (bAtomActive) { olc_CoreUpdate(); }
+			// Run as fast as allowed
+			while (bAtomActive) { olc_CoreUpdate(); PaceFrame(); }
 
 			// Allow the user to free resources if they have overrided the destroy function
 			if (!OnUserDestroy())
@@ -3117,6 +4579,8 @@ namespace olc
 			}
 		}
 
+		if (ofsInputRecord.is_open()) ofsInputRecord.close();
+
 		platform->ThreadCleanUp();
 	}
 
@@ -3134,15 +4598,18 @@ namespace olc
 		vLayers[0].bShow = true;
 		SetDrawTarget(nullptr);
 
-		m_tp1 = std::chrono::system_clock::now();
-		m_tp2 = std::chrono::system_clock::now();
+		m_tp1 = std::chrono::steady_clock::now();
+		m_tp2 = std::chrono::steady_clock::now();
+		tpNextFrame = m_tp2;
 	}
 
 
 	void PixelGameEngine::olc_CoreUpdate()
 	{
+		OLC_PROFILE_ZONE("frame");
+
 		// Handle Timing
-		m_tp2 = std::chrono::system_clock::now();
+		m_tp2 = std::chrono::steady_clock::now();
 		std::chrono::duration<float> elapsedTime = m_tp2 - m_tp1;
 		m_tp1 = m_tp2;
 
@@ -3150,9 +4617,43 @@ namespace olc
 		float fElapsedTime = elapsedTime.count();
 		fLastElapsed = fElapsedTime;
 
+		// Phase timings, each Lap() returns milliseconds since the previous one, and with
+		// OLC_PROFILE also records the phase as a zone
+		FrameTiming timing;
+		timing.nFrame = nFrameIndex++;
+		const AllocStats allocStart = GetAllocStats();
+		auto tpLap = m_tp2;
+		auto Lap = [&tpLap](const char* sPhase)
+		{
+			const auto tp = std::chrono::steady_clock::now();
+			const float fMs = std::chrono::duration<float, std::milli>(tp - tpLap).count();
+#if defined(OLC_PROFILE)
+			ProfileRecord(sPhase, tpLap, tp);
+#else
+			UNUSED(sPhase);
+#endif
+			tpLap = tp;
+			return fMs;
+		};
+
 		// Some platforms will need to check for events
 		platform->HandleSystemEvent();
 
+		// A replay overwrites whatever the platform delivered
+		if (bInputReplay && !ReplayInputFrame(fElapsedTime))
+		{
+			bInputReplay = false;
+			olc_Terminate();
+			return;
+		}
+
+		// Idle with nothing new to respond to, leave everything as it is. Checked before
+		// the input scan so no pressed or released transitions are lost
+		const uint32_t nEvents = nInputEvents;
+		if (bIdleMode && !bInputReplay && !bFrameRequested.exchange(false) && nEvents == nInputEventsSeen)
+			return;
+		nInputEventsSeen = nEvents;
+
 		// Compare hardware input states from previous frame
 		auto ScanHardware = [&](HWButton* pKeys, bool* pStateOld, bool* pStateNew, uint32_t nKeyCount)
 		{
@@ -3184,6 +4685,8 @@ namespace olc
 		vMousePos = vMousePosCache;
 		nMouseWheelDelta = nMouseWheelDeltaCache;
 		nMouseWheelDeltaCache = 0;
+		if (ofsInputRecord.is_open()) RecordInputFrame(fElapsedTime);
+		timing.fInput = Lap("input");
 
 		//	renderer->ClearBuffer(olc::BLACK, true);
 
@@ -3192,18 +4695,52 @@ namespace olc
 		for (auto& ext : vExtensions) bExtensionBlockFrame |= ext->OnBeforeUserUpdate(fElapsedTime);
 		if (!bExtensionBlockFrame)
 		{
+			if (fFixedStep > 0.0f)
+			{
+				fFixedAccumulator += fElapsedTime;
+				uint32_t nTicks = 0;
+				for (; fFixedAccumulator >= fFixedStep && nTicks < nFixedMaxTicks; nTicks++, nFixedTick++)
+				{
+					if (!OnFixedUpdate(fFixedStep)) bAtomActive = false;
+					fFixedAccumulator -= fFixedStep;
+				}
+				// Too far behind to catch up, e.g. after a stall, so carry no more than a tick
+				fFixedAccumulator = std::min(fFixedAccumulator, fFixedStep);
+				fFixedAlpha = std::min(fFixedAccumulator / fFixedStep, 1.0f);
+			}
+			else
+			{
+				if (!OnFixedUpdate(fElapsedTime)) bAtomActive = false;
+				nFixedTick++;
+			}
 			if (!OnUserUpdate(fElapsedTime)) bAtomActive = false;
 		}
 		for (auto& ext : vExtensions) ext->OnAfterUserUpdate(fElapsedTime);
+		FlushCommandList();
+		timing.fUpdate = Lap("update");
+
+		// Nothing changed, so the last presented frame can stay up
+		if (bSkipFrame && !bForcePresent)
+		{
+			bSkipFrame = false;
+			for (auto& layer : vLayers) layer.vecDecalInstance.clear();
+			arenaDecals.Reset();
+			return;
+		}
+		bSkipFrame = false;
+		bForcePresent = false;
+
+		if (bShowFrameStats) DrawFrameStats();
 
 		// Display Frame
 		renderer->UpdateViewport(vViewPos, vViewSize);
 		renderer->ClearBuffer(olc::BLACK, true);
 
-		// Layer 0 must always exist
-		vLayers[0].bUpdate = true;
+		// Layer 0 must always be shown, but is only uploaded when it has been drawn to
 		vLayers[0].bShow = true;
 		SetDecalMode(DecalMode::NORMAL);
+		renderer->nDrawCalls = 0;
+		renderer->nVertices = 0;
 		renderer->PrepareDrawing();
 
 		for (auto layer = vLayers.rbegin(); layer != vLayers.rend(); ++layer)
@@ -3215,16 +4752,20 @@ namespace olc
 					renderer->ApplyTexture(layer->pDrawTarget.Decal()->id);
 					if (layer->bUpdate)
 					{
+						const auto tpUpload = std::chrono::steady_clock::now();
 						layer->pDrawTarget.Decal()->Update();
 						layer->bUpdate = false;
+						const auto tpUploaded = std::chrono::steady_clock::now();
+						timing.fUpload += std::chrono::duration<float, std::milli>(tpUploaded - tpUpload).count();
+#if defined(OLC_PROFILE)
+						ProfileRecord("upload", tpUpload, tpUploaded);
+#endif
 					}
 
 					renderer->DrawLayerQuad(layer->vOffset, layer->vScale, layer->tint);
 
 					// Display Decals in order for this layer
-					for (auto& decal : layer->vecDecalInstance)
-						renderer->DrawDecal(decal);
-					layer->vecDecalInstance.clear();
+					renderer->DrawDecals(layer->vecDecalInstance);
 				}
 				else
 				{
@@ -3234,8 +4775,30 @@ namespace olc
 			}
 		}
 
+		timing.fDecals = Lap("decals") - timing.fUpload;
+
+		// Hidden and hooked layers drop their decals too, the geometry is about to go
+		for (auto& layer : vLayers) layer.vecDecalInstance.clear();
+		arenaDecals.Reset();
+
 		// Present Graphics to screen
 		renderer->DisplayFrame();
+		timing.fPresent = Lap("present");
+		timing.fFrame = std::chrono::duration<float, std::milli>(tpLap - m_tp2).count();
+		timing.nDrawCalls = renderer->nDrawCalls;
+		timing.nVertices = renderer->nVertices;
+		const AllocStats allocEnd = GetAllocStats();
+		timing.nAllocations = uint32_t(allocEnd.nAllocations - allocStart.nAllocations);
+		timing.nAllocBytes = allocEnd.nBytes - allocStart.nBytes;
+#if defined(OLC_ALLOC_STATS)
+		CollectAllocScopes(vAllocScopes);
+#endif
+
+		if (vFrameTimings.size() < nFrameHistory)
+			vFrameTimings.push_back(timing);
+		else
+			vFrameTimings[nFrameTimingNext] = timing;
+		nFrameTimingNext = (nFrameTimingNext + 1) % nFrameHistory;
 
 		// Update Title Bar
 		fFrameTimer += fElapsedTime;
@@ -3558,6 +5121,8 @@ namespace olc
 
 		void DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) override
 		{
+			nDrawCalls++;
+			nVertices += 4;
 			glBegin(GL_QUADS);
 			glColor4ub(tint.r, tint.g, tint.b, tint.a);
 			glTexCoord2f(0.0f * scale.x + offset.x, 1.0f * scale.y + offset.y);
@@ -3573,6 +5138,8 @@ namespace olc
 
 		void DrawDecal(const olc::DecalInstance& decal) override
 		{
+			nDrawCalls++;
+			nVertices += decal.points;
 			SetDecalMode(decal.mode);
 
 			if (decal.decal == nullptr)
@@ -3854,6 +5421,7 @@ namespace olc
 		uint32_t m_nVS = 0;
 		uint32_t m_nQuadShader = 0;
 		uint32_t m_vbQuad = 0;
+		uint32_t m_ibQuad = 0;
 		uint32_t m_vaQuad = 0;
 
 		struct locVertex
@@ -3865,6 +5433,11 @@ namespace olc
 
 		locVertex pVertexMem[OLC_MAX_VERTS];
 
+		// Consecutive decals sharing texture and mode are merged into one indexed draw,
+		// these keep their capacity from frame to frame
+		std::vector<locVertex> vBatchVertices;
+		std::vector<GLuint> vBatchIndices;
+
 		olc::Renderable rendBlankQuad;
 
 	public:
@@ -4033,9 +5606,11 @@ namespace olc
 
 			// Create Quad
 			locGenBuffers(1, &m_vbQuad);
+			locGenBuffers(1, &m_ibQuad);
 			locGenVertexArrays(1, &m_vaQuad);
 			locBindVertexArray(m_vaQuad);
 			locBindBuffer(0x8892, m_vbQuad);
+			locBindBuffer(0x8893, m_ibQuad);
 
 			locVertex verts[OLC_MAX_VERTS];
 			locBufferData(0x8892, sizeof(locVertex) * OLC_MAX_VERTS, verts, 0x88E0);
@@ -4090,156 +5665,611 @@ namespace olc
 			X11::glXSwapBuffers(olc_Display, *olc_Window);
 #endif		
 
-#if defined(OLC_PLATFORM_GLUT)
-			glutSwapBuffers();
-#endif
+#if defined(OLC_PLATFORM_GLUT)
+			glutSwapBuffers();
+#endif
+
+#if defined(OLC_PLATFORM_EMSCRIPTEN)
+			eglSwapBuffers(olc_Display, olc_Surface);
+#endif
+		}
+
+		void PrepareDrawing() override
+		{
+			glEnable(GL_BLEND);
+			nDecalMode = DecalMode::NORMAL;
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			locUseProgram(m_nQuadShader);
+			locBindVertexArray(m_vaQuad);
+
+#if defined(OLC_PLATFORM_EMSCRIPTEN)
+			locVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(locVertex), 0); locEnableVertexAttribArray(0);
+			locVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(locVertex), (void*)(3 * sizeof(float))); locEnableVertexAttribArray(1);
+			locVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(locVertex), (void*)(5 * sizeof(float)));	locEnableVertexAttribArray(2);
+#endif
+		}
+
+		void SetDecalMode(const olc::DecalMode& mode) override
+		{
+			if (mode != nDecalMode)
+			{
+				switch (mode)
+				{
+				case olc::DecalMode::NORMAL: glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);	break;
+				case olc::DecalMode::ADDITIVE: glBlendFunc(GL_SRC_ALPHA, GL_ONE); break;
+				case olc::DecalMode::MULTIPLICATIVE: glBlendFunc(GL_DST_COLOR, GL_ONE_MINUS_SRC_ALPHA);	break;
+				case olc::DecalMode::STENCIL: glBlendFunc(GL_ZERO, GL_SRC_ALPHA); break;
+				case olc::DecalMode::ILLUMINATE: glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA);	break;
+				case olc::DecalMode::WIREFRAME: glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);	break;
+				}
+
+				nDecalMode = mode;
+			}
+		}
+
+		void DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) override
+		{
+			locBindBuffer(0x8892, m_vbQuad);
+			locVertex verts[4] = {
+				{{-1.0f, -1.0f, 1.0}, {0.0f * scale.x + offset.x, 1.0f * scale.y + offset.y}, tint},
+				{{+1.0f, -1.0f, 1.0}, {1.0f * scale.x + offset.x, 1.0f * scale.y + offset.y}, tint},
+				{{-1.0f, +1.0f, 1.0}, {0.0f * scale.x + offset.x, 0.0f * scale.y + offset.y}, tint},
+				{{+1.0f, +1.0f, 1.0}, {1.0f * scale.x + offset.x, 0.0f * scale.y + offset.y}, tint},
+			};
+
+			locBufferData(0x8892, sizeof(locVertex) * 4, verts, 0x88E0);
+			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+			nDrawCalls++;
+			nVertices += 4;
+		}
+
+		void DrawDecal(const olc::DecalInstance& decal) override
+		{
+			SetDecalMode(decal.mode);
+			if (decal.decal == nullptr)
+				glBindTexture(GL_TEXTURE_2D, rendBlankQuad.Decal()->id);
+			else
+				glBindTexture(GL_TEXTURE_2D, decal.decal->id);
+
+			locBindBuffer(0x8892, m_vbQuad);
+
+			for (uint32_t i = 0; i < decal.points; i++)
+				pVertexMem[i] = { { decal.pos[i].x, decal.pos[i].y, decal.w[i] }, { decal.uv[i].x, decal.uv[i].y }, decal.tint[i] };
+
+			locBufferData(0x8892, sizeof(locVertex) * decal.points, pVertexMem, 0x88E0);
+
+			if (nDecalMode == DecalMode::WIREFRAME)
+				glDrawArrays(GL_LINE_LOOP, 0, decal.points);
+			else
+				glDrawArrays(GL_TRIANGLE_FAN, 0, decal.points);
+			nDrawCalls++;
+			nVertices += decal.points;
+		}
+
+		void DrawDecals(const std::vector<olc::DecalInstance>& decals) override
+		{
+			auto TextureOf = [&](const olc::DecalInstance& decal)
+			{ return decal.decal == nullptr ? rendBlankQuad.Decal()->id : decal.decal->id; };
+
+			// Only neighbours are merged, reordering would change how overlapping decals blend
+			size_t i = 0;
+			while (i < decals.size())
+			{
+				const uint32_t nTexture = TextureOf(decals[i]);
+				const olc::DecalMode nMode = decals[i].mode;
+				const bool bLines = nMode == DecalMode::WIREFRAME;
+
+				vBatchVertices.clear();
+				vBatchIndices.clear();
+				for (; i < decals.size() && decals[i].mode == nMode && TextureOf(decals[i]) == nTexture; i++)
+				{
+					const olc::DecalInstance& decal = decals[i];
+					const GLuint nBase = GLuint(vBatchVertices.size());
+					for (uint32_t n = 0; n < decal.points; n++)
+						vBatchVertices.push_back({ { decal.pos[n].x, decal.pos[n].y, decal.w[n] }, { decal.uv[n].x, decal.uv[n].y }, decal.tint[n] });
+
+					// Expand each structure into plain lines or triangles
+					if (bLines)
+					{
+						for (uint32_t n = 0; n < decal.points && decal.points > 1; n++)
+							vBatchIndices.insert(vBatchIndices.end(), { nBase + n, nBase + (n + 1) % decal.points });
+					}
+					else if (decal.structure == olc::DecalStructure::STRIP)
+					{
+						for (uint32_t n = 0; n + 2 < decal.points; n++)
+							vBatchIndices.insert(vBatchIndices.end(), { nBase + n + (n & 1), nBase + n + 1 - (n & 1), nBase + n + 2 });
+					}
+					else if (decal.structure == olc::DecalStructure::LIST)
+					{
+						for (uint32_t n = 0; n + 2 < decal.points; n += 3)
+							vBatchIndices.insert(vBatchIndices.end(), { nBase + n, nBase + n + 1, nBase + n + 2 });
+					}
+					else
+					{
+						for (uint32_t n = 1; n + 1 < decal.points; n++)
+							vBatchIndices.insert(vBatchIndices.end(), { nBase, nBase + n, nBase + n + 1 });
+					}
+				}
+
+				if (vBatchIndices.empty()) continue;
+
+				SetDecalMode(nMode);
+				glBindTexture(GL_TEXTURE_2D, nTexture);
+
+				// Respecifying the whole store each batch lets the driver hand us fresh memory
+				// rather than wait for the previous draw to finish with it
+				locBindBuffer(0x8892, m_vbQuad);
+				locBufferData(0x8892, sizeof(locVertex) * vBatchVertices.size(), vBatchVertices.data(), 0x88E0);
+				locBindBuffer(0x8893, m_ibQuad);
+				locBufferData(0x8893, sizeof(GLuint) * vBatchIndices.size(), vBatchIndices.data(), 0x88E0);
+				glDrawElements(bLines ? GL_LINES : GL_TRIANGLES, GLsizei(vBatchIndices.size()), GL_UNSIGNED_INT, nullptr);
+
+				nDrawCalls++;
+				nVertices += uint32_t(vBatchVertices.size());
+			}
+		}
+
+		uint32_t CreateTexture(const uint32_t width, const uint32_t height, const bool filtered, const bool clamp) override
+		{
+			UNUSED(width);
+			UNUSED(height);
+			uint32_t id = 0;
+			glGenTextures(1, &id);
+			glBindTexture(GL_TEXTURE_2D, id);
+
+			if (filtered)
+			{
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			}
+			else
+			{
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			}
+
+			if (clamp)
+			{
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+			}
+			else
+			{
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+			}
+#if !defined(OLC_PLATFORM_EMSCRIPTEN)
+			glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+#endif
+			return id;
+		}
+
+		uint32_t DeleteTexture(const uint32_t id) override
+		{
+			glDeleteTextures(1, &id);
+			return id;
+		}
+
+		void UpdateTexture(uint32_t id, olc::Sprite* spr) override
+		{
+			UNUSED(id);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, spr->width, spr->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
+		}
+
+		void ReadTexture(uint32_t id, olc::Sprite* spr) override
+		{
+			glReadPixels(0, 0, spr->width, spr->height, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
+		}
+
+		void ApplyTexture(uint32_t id) override
+		{
+			glBindTexture(GL_TEXTURE_2D, id);
+		}
+
+		void ClearBuffer(olc::Pixel p, bool bDepth) override
+		{
+			glClearColor(float(p.r) / 255.0f, float(p.g) / 255.0f, float(p.b) / 255.0f, float(p.a) / 255.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+			if (bDepth) glClear(GL_DEPTH_BUFFER_BIT);
+		}
+
+		void UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) override
+		{
+			glViewport(pos.x, pos.y, size.x, size.y);
+		}
+	};
+}
+#endif
+// O------------------------------------------------------------------------------O
+// | END RENDERER: OpenGL 3.3 (3.0 es) (sh-sh-sh-shaders....)                     |
+// O------------------------------------------------------------------------------O
+#pragma endregion
+
+#pragma region renderer_null
+// O------------------------------------------------------------------------------O
+// | START RENDERER: Null (software) - no GPU, frames live in main memory         |
+// O------------------------------------------------------------------------------O
+#if defined(OLC_GFX_NULL)
+namespace olc
+{
+	class Renderer_Null : public olc::Renderer
+	{
+	private:
+		struct locTexture
+		{
+			olc::Sprite spr;
+			bool bFiltered = false;
+			bool bClamp = true;
+		};
+
+		struct locVertex
+		{
+			float x, y;			// Window space
+			float u, v, q;		// Projective texture coordinates
+			float r, g, b, a;	// Normalised tint
+		};
+
+		std::map<uint32_t, std::unique_ptr<locTexture>> mapTextures;
+		uint32_t nNextTextureID = 1;
+		locTexture* pBoundTexture = nullptr;
+		olc::DecalMode nDecalMode = olc::DecalMode::NORMAL;
+		olc::vi2d vViewPos = { 0, 0 };
+		olc::vi2d vViewSize = { 0, 0 };
+		olc::Sprite sprFrame;
+		uint32_t nFramesPresented = 0;
+
+	public:
+		void PrepareDevice() override
+		{}
+
+		olc::rcode CreateDevice(std::vector<void*> params, bool bFullScreen, bool bVSYNC) override
+		{
+			UNUSED(params);
+			UNUSED(bFullScreen);
+			UNUSED(bVSYNC);
+			nFramesPresented = 0;
+			return olc::rcode::OK;
+		}
+
+		olc::rcode DestroyDevice() override
+		{
+			mapTextures.clear();
+			pBoundTexture = nullptr;
+			return olc::rcode::OK;
+		}
+
+		void DisplayFrame() override
+		{
+#if defined(OLC_PLATFORM_HEADLESS)
+			const olc::HeadlessConfig& config = ptrPGE->GetHeadlessConfig();
+			const uint32_t nFrame = nFramesPresented++;
+			if (config.sFramePath.empty() || nFrame % std::max(config.nDumpInterval, 1u) != 0)
+				return;
+
+			// Substitute the run of '#' with the zero padded frame number
+			std::string sFile = config.sFramePath;
+			size_t nHashStart = sFile.find('#');
+			if (nHashStart != std::string::npos)
+			{
+				size_t nHashEnd = sFile.find_first_not_of('#', nHashStart);
+				if (nHashEnd == std::string::npos) nHashEnd = sFile.size();
+				std::string sNumber = std::to_string(nFrame);
+				if (sNumber.size() < nHashEnd - nHashStart)
+					sNumber.insert(0, nHashEnd - nHashStart - sNumber.size(), '0');
+				sFile.replace(nHashStart, nHashEnd - nHashStart, sNumber);
+			}
 
-#if defined(OLC_PLATFORM_EMSCRIPTEN)
-			eglSwapBuffers(olc_Display, olc_Surface);
+			if (sFile.size() >= 4 && sFile.compare(sFile.size() - 4, 4, ".raw") == 0)
+			{
+				std::ofstream ofs(sFile, std::ofstream::binary);
+				ofs.write((const char*)sprFrame.GetData(), sprFrame.pColData.size() * sizeof(olc::Pixel));
+			}
+			else if (olc::Sprite::loader)
+				olc::Sprite::loader->SaveImageResource(&sprFrame, sFile);
+#else
+			nFramesPresented++;
 #endif
 		}
 
 		void PrepareDrawing() override
 		{
-			glEnable(GL_BLEND);
-			nDecalMode = DecalMode::NORMAL;
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-			locUseProgram(m_nQuadShader);
-			locBindVertexArray(m_vaQuad);
-
-#if defined(OLC_PLATFORM_EMSCRIPTEN)
-			locVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(locVertex), 0); locEnableVertexAttribArray(0);
-			locVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(locVertex), (void*)(3 * sizeof(float))); locEnableVertexAttribArray(1);
-			locVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(locVertex), (void*)(5 * sizeof(float)));	locEnableVertexAttribArray(2);
-#endif
+			nDecalMode = olc::DecalMode::NORMAL;
 		}
 
 		void SetDecalMode(const olc::DecalMode& mode) override
 		{
-			if (mode != nDecalMode)
-			{
-				switch (mode)
-				{
-				case olc::DecalMode::NORMAL: glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);	break;
-				case olc::DecalMode::ADDITIVE: glBlendFunc(GL_SRC_ALPHA, GL_ONE); break;
-				case olc::DecalMode::MULTIPLICATIVE: glBlendFunc(GL_DST_COLOR, GL_ONE_MINUS_SRC_ALPHA);	break;
-				case olc::DecalMode::STENCIL: glBlendFunc(GL_ZERO, GL_SRC_ALPHA); break;
-				case olc::DecalMode::ILLUMINATE: glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA);	break;
-				case olc::DecalMode::WIREFRAME: glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);	break;
-				}
-
-				nDecalMode = mode;
-			}
+			nDecalMode = mode;
 		}
 
 		void DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) override
 		{
-			locBindBuffer(0x8892, m_vbQuad);
-			locVertex verts[4] = {
-				{{-1.0f, -1.0f, 1.0}, {0.0f * scale.x + offset.x, 1.0f * scale.y + offset.y}, tint},
-				{{+1.0f, -1.0f, 1.0}, {1.0f * scale.x + offset.x, 1.0f * scale.y + offset.y}, tint},
-				{{-1.0f, +1.0f, 1.0}, {0.0f * scale.x + offset.x, 0.0f * scale.y + offset.y}, tint},
-				{{+1.0f, +1.0f, 1.0}, {1.0f * scale.x + offset.x, 0.0f * scale.y + offset.y}, tint},
-			};
+			nDrawCalls++;
+			nVertices += 4;
+			if (pBoundTexture == nullptr || vViewSize.x <= 0 || vViewSize.y <= 0) return;
+			const float fTint[4] = { tint.r / 255.0f, tint.g / 255.0f, tint.b / 255.0f, tint.a / 255.0f };
+			const bool bPlain = tint == olc::WHITE && !pBoundTexture->bFiltered;
 
-			locBufferData(0x8892, sizeof(locVertex) * 4, verts, 0x88E0);
-			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+			for (int32_t y = 0; y < vViewSize.y; y++)
+			{
+				const float v = (float(y) + 0.5f) / float(vViewSize.y) * scale.y + offset.y;
+				olc::Pixel* pDst = sprFrame.GetData() + (vViewPos.y + y) * sprFrame.width + vViewPos.x;
+				for (int32_t x = 0; x < vViewSize.x; x++)
+				{
+					const float u = (float(x) + 0.5f) / float(vViewSize.x) * scale.x + offset.x;
+					olc::Pixel p = SampleTexture(*pBoundTexture, u, v);
+					if (!bPlain) p = Modulate(p, fTint);
+					Blend(p, pDst[x]);
+				}
+			}
 		}
 
 		void DrawDecal(const olc::DecalInstance& decal) override
 		{
+			nDrawCalls++;
+			nVertices += decal.points;
 			SetDecalMode(decal.mode);
-			if (decal.decal == nullptr)
-				glBindTexture(GL_TEXTURE_2D, rendBlankQuad.Decal()->id);
-			else
-				glBindTexture(GL_TEXTURE_2D, decal.decal->id);
-
-			locBindBuffer(0x8892, m_vbQuad);
-
-			for (uint32_t i = 0; i < decal.points; i++)
-				pVertexMem[i] = { { decal.pos[i].x, decal.pos[i].y, decal.w[i] }, { decal.uv[i].x, decal.uv[i].y }, decal.tint[i] };
+			if (decal.points == 0 || nDecalMode == olc::DecalMode::MODEL3D) return;
 
-			locBufferData(0x8892, sizeof(locVertex) * decal.points, pVertexMem, 0x88E0);
+			locTexture* pTexture = nullptr;
+			if (decal.decal != nullptr)
+			{
+				auto it = mapTextures.find(uint32_t(decal.decal->id));
+				if (it != mapTextures.end()) pTexture = it->second.get();
+			}
 
-			if (nDecalMode == DecalMode::WIREFRAME)
-				glDrawArrays(GL_LINE_LOOP, 0, decal.points);
-			else
-				glDrawArrays(GL_TRIANGLE_FAN, 0, decal.points);
-		}
+			auto ToWindow = [&](uint32_t i)
+			{
+				locVertex v;
+				v.x = float(vViewPos.x) + (decal.pos[i].x + 1.0f) * 0.5f * float(vViewSize.x);
+				v.y = float(vViewPos.y) + (1.0f - decal.pos[i].y) * 0.5f * float(vViewSize.y);
+				v.u = decal.uv[i].x; v.v = decal.uv[i].y; v.q = decal.w[i];
+				v.r = decal.tint[i].r / 255.0f; v.g = decal.tint[i].g / 255.0f;
+				v.b = decal.tint[i].b / 255.0f; v.a = decal.tint[i].a / 255.0f;
+				return v;
+			};
 
-		uint32_t CreateTexture(const uint32_t width, const uint32_t height, const bool filtered, const bool clamp) override
-		{
-			UNUSED(width);
-			UNUSED(height);
-			uint32_t id = 0;
-			glGenTextures(1, &id);
-			glBindTexture(GL_TEXTURE_2D, id);
+			if (nDecalMode == olc::DecalMode::WIREFRAME)
+			{
+				for (uint32_t i = 0; i < decal.points; i++)
+					RasteriseLine(ToWindow(i), ToWindow((i + 1) % decal.points));
+				return;
+			}
 
-			if (filtered)
+			if (decal.structure == olc::DecalStructure::LINE)
 			{
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+				for (uint32_t i = 0; i + 1 < decal.points; i++)
+					RasteriseLine(ToWindow(i), ToWindow(i + 1));
 			}
-			else
+			else if (decal.structure == olc::DecalStructure::STRIP)
 			{
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+				for (uint32_t i = 0; i + 2 < decal.points; i++)
+					RasteriseTriangle(pTexture, ToWindow(i), ToWindow(i + 1), ToWindow(i + 2));
 			}
-
-			if (clamp)
+			else if (decal.structure == olc::DecalStructure::LIST)
 			{
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+				for (uint32_t i = 0; i + 2 < decal.points; i += 3)
+					RasteriseTriangle(pTexture, ToWindow(i), ToWindow(i + 1), ToWindow(i + 2));
 			}
 			else
 			{
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+				for (uint32_t i = 1; i + 1 < decal.points; i++)
+					RasteriseTriangle(pTexture, ToWindow(0), ToWindow(i), ToWindow(i + 1));
 			}
-#if !defined(OLC_PLATFORM_EMSCRIPTEN)
-			glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-#endif
+		}
+
+		uint32_t CreateTexture(const uint32_t width, const uint32_t height, const bool filtered, const bool clamp) override
+		{
+			auto tex = std::make_unique<locTexture>();
+			tex->spr.width = width;
+			tex->spr.height = height;
+			tex->spr.pColData.resize(width * height, olc::BLANK);
+			tex->bFiltered = filtered;
+			tex->bClamp = clamp;
+			uint32_t id = nNextTextureID++;
+			pBoundTexture = tex.get();
+			mapTextures[id] = std::move(tex);
 			return id;
 		}
 
 		uint32_t DeleteTexture(const uint32_t id) override
 		{
-			glDeleteTextures(1, &id);
+			auto it = mapTextures.find(id);
+			if (it != mapTextures.end())
+			{
+				if (pBoundTexture == it->second.get()) pBoundTexture = nullptr;
+				mapTextures.erase(it);
+			}
 			return id;
 		}
 
 		void UpdateTexture(uint32_t id, olc::Sprite* spr) override
 		{
-			UNUSED(id);
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, spr->width, spr->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
+			auto it = mapTextures.find(id);
+			if (it == mapTextures.end() || spr == nullptr) return;
+			olc::Sprite& tex = it->second->spr;
+			tex.width = spr->width;
+			tex.height = spr->height;
+			tex.pColData = spr->pColData;
 		}
 
 		void ReadTexture(uint32_t id, olc::Sprite* spr) override
 		{
-			glReadPixels(0, 0, spr->width, spr->height, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
+			// Matches glReadPixels(), which reads back the frame rather than the texture
+			UNUSED(id);
+			for (int32_t y = 0; y < std::min(spr->height, sprFrame.height); y++)
+				std::memcpy(spr->GetData() + y * spr->width, sprFrame.GetData() + y * sprFrame.width,
+					std::min(spr->width, sprFrame.width) * sizeof(olc::Pixel));
 		}
 
 		void ApplyTexture(uint32_t id) override
 		{
-			glBindTexture(GL_TEXTURE_2D, id);
+			auto it = mapTextures.find(id);
+			pBoundTexture = it != mapTextures.end() ? it->second.get() : nullptr;
 		}
 
 		void ClearBuffer(olc::Pixel p, bool bDepth) override
 		{
-			glClearColor(float(p.r) / 255.0f, float(p.g) / 255.0f, float(p.b) / 255.0f, float(p.a) / 255.0f);
-			glClear(GL_COLOR_BUFFER_BIT);
-			if (bDepth) glClear(GL_DEPTH_BUFFER_BIT);
+			UNUSED(bDepth);
+			std::fill(sprFrame.pColData.begin(), sprFrame.pColData.end(), p);
 		}
 
 		void UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) override
 		{
-			glViewport(pos.x, pos.y, size.x, size.y);
+			vViewPos = pos;
+			vViewSize = size;
+
+			// The frame covers the whole "window", the viewport is centred in it
+			const olc::vi2d vFrameSize = size + pos * 2;
+			if (vFrameSize.x != sprFrame.width || vFrameSize.y != sprFrame.height)
+			{
+				sprFrame.width = vFrameSize.x;
+				sprFrame.height = vFrameSize.y;
+				sprFrame.pColData.assign(size_t(vFrameSize.x) * size_t(vFrameSize.y), olc::BLACK);
+			}
+		}
+
+	private:
+		static olc::Pixel Modulate(const olc::Pixel p, const float* fTint)
+		{
+			return olc::Pixel(uint8_t(p.r * fTint[0]), uint8_t(p.g * fTint[1]), uint8_t(p.b * fTint[2]), uint8_t(p.a * fTint[3]));
+		}
+
+		static olc::Pixel SampleTexture(const locTexture& tex, float u, float v)
+		{
+			const olc::Sprite& spr = tex.spr;
+			if (spr.width == 0 || spr.height == 0) return olc::WHITE;
+
+			auto Fetch = [&](int32_t x, int32_t y)
+			{
+				if (tex.bClamp)
+				{
+					x = std::max(0, std::min(x, spr.width - 1));
+					y = std::max(0, std::min(y, spr.height - 1));
+				}
+				else
+				{
+					x = ((x % spr.width) + spr.width) % spr.width;
+					y = ((y % spr.height) + spr.height) % spr.height;
+				}
+				return spr.pColData[y * spr.width + x];
+			};
+
+			const float fx = u * float(spr.width);
+			const float fy = v * float(spr.height);
+			if (!tex.bFiltered)
+				return Fetch(int32_t(std::floor(fx)), int32_t(std::floor(fy)));
+
+			const float bx = fx - 0.5f, by = fy - 0.5f;
+			const int32_t x0 = int32_t(std::floor(bx)), y0 = int32_t(std::floor(by));
+			const float tx = bx - float(x0), ty = by - float(y0);
+			const olc::Pixel p00 = Fetch(x0, y0), p10 = Fetch(x0 + 1, y0);
+			const olc::Pixel p01 = Fetch(x0, y0 + 1), p11 = Fetch(x0 + 1, y0 + 1);
+			auto Mix = [&](uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+			{ return uint8_t((a * (1.0f - tx) + b * tx) * (1.0f - ty) + (c * (1.0f - tx) + d * tx) * ty); };
+			return olc::Pixel(Mix(p00.r, p10.r, p01.r, p11.r), Mix(p00.g, p10.g, p01.g, p11.g),
+				Mix(p00.b, p10.b, p01.b, p11.b), Mix(p00.a, p10.a, p01.a, p11.a));
+		}
+
+		// Same blend equations the OpenGL renderers set up in SetDecalMode()
+		void Blend(const olc::Pixel src, olc::Pixel& dst) const
+		{
+			if (nDecalMode == olc::DecalMode::NORMAL || nDecalMode == olc::DecalMode::WIREFRAME)
+			{
+				if (src.a == 255) { dst = src; return; }
+				if (src.a == 0) return;
+			}
+
+			const float sa = src.a / 255.0f;
+			auto Channel = [&](uint8_t cs, uint8_t cd)
+			{
+				const float fs = cs / 255.0f, fd = cd / 255.0f;
+				float o = 0.0f;
+				switch (nDecalMode)
+				{
+				case olc::DecalMode::ADDITIVE:       o = fs * sa + fd; break;
+				case olc::DecalMode::MULTIPLICATIVE: o = fs * fd + fd * (1.0f - sa); break;
+				case olc::DecalMode::STENCIL:        o = fd * sa; break;
+				case olc::DecalMode::ILLUMINATE:     o = fs * (1.0f - sa) + fd * sa; break;
+				default:                             o = fs * sa + fd * (1.0f - sa); break;
+				}
+				return uint8_t(std::min(1.0f, o) * 255.0f + 0.5f);
+			};
+			dst = olc::Pixel(Channel(src.r, dst.r), Channel(src.g, dst.g), Channel(src.b, dst.b), Channel(src.a, dst.a));
+		}
+
+		void RasteriseTriangle(locTexture* pTexture, locVertex v0, locVertex v1, locVertex v2)
+		{
+			auto Edge = [](const locVertex& a, const locVertex& b, float px, float py)
+			{ return (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x); };
+
+			float fArea = Edge(v0, v1, v2.x, v2.y);
+			if (fArea == 0.0f) return;
+			if (fArea < 0.0f) { std::swap(v1, v2); fArea = -fArea; }
+
+			// Top-left fill convention, so fans don't blend shared edges twice
+			auto TopLeft = [](const locVertex& a, const locVertex& b)
+			{ return (b.y - a.y) < 0.0f || ((b.y - a.y) == 0.0f && (b.x - a.x) > 0.0f); };
+			const bool bTL0 = TopLeft(v1, v2), bTL1 = TopLeft(v2, v0), bTL2 = TopLeft(v0, v1);
+
+			const int32_t nMinX = std::max(vViewPos.x, int32_t(std::floor(std::min({ v0.x, v1.x, v2.x }))));
+			const int32_t nMinY = std::max(vViewPos.y, int32_t(std::floor(std::min({ v0.y, v1.y, v2.y }))));
+			const int32_t nMaxX = std::min(vViewPos.x + vViewSize.x - 1, int32_t(std::ceil(std::max({ v0.x, v1.x, v2.x }))));
+			const int32_t nMaxY = std::min(vViewPos.y + vViewSize.y - 1, int32_t(std::ceil(std::max({ v0.y, v1.y, v2.y }))));
+			const float fInvArea = 1.0f / fArea;
+
+			for (int32_t y = nMinY; y <= nMaxY; y++)
+			{
+				const float py = float(y) + 0.5f;
+				olc::Pixel* pRow = sprFrame.GetData() + y * sprFrame.width;
+				for (int32_t x = nMinX; x <= nMaxX; x++)
+				{
+					const float px = float(x) + 0.5f;
+					const float w0 = Edge(v1, v2, px, py);
+					const float w1 = Edge(v2, v0, px, py);
+					const float w2 = Edge(v0, v1, px, py);
+					if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+					if ((w0 == 0.0f && !bTL0) || (w1 == 0.0f && !bTL1) || (w2 == 0.0f && !bTL2)) continue;
+
+					// Perspective correct, as the OpenGL 3.3 shader divides by q
+					const float b0 = w0 * fInvArea, b1 = w1 * fInvArea, b2 = w2 * fInvArea;
+					const float q = b0 * v0.q + b1 * v1.q + b2 * v2.q;
+					const float iq = q != 0.0f ? 1.0f / q : 0.0f;
+					const float c0 = b0 * v0.q * iq, c1 = b1 * v1.q * iq, c2 = b2 * v2.q * iq;
+					const float fTint[4] = {
+						c0 * v0.r + c1 * v1.r + c2 * v2.r, c0 * v0.g + c1 * v1.g + c2 * v2.g,
+						c0 * v0.b + c1 * v1.b + c2 * v2.b, c0 * v0.a + c1 * v1.a + c2 * v2.a };
+
+					olc::Pixel p = olc::WHITE;
+					if (pTexture != nullptr)
+						p = SampleTexture(*pTexture, (b0 * v0.u + b1 * v1.u + b2 * v2.u) * iq, (b0 * v0.v + b1 * v1.v + b2 * v2.v) * iq);
+					Blend(Modulate(p, fTint), pRow[x]);
+				}
+			}
+		}
+
+		void RasteriseLine(const locVertex& v0, const locVertex& v1)
+		{
+			int32_t x0 = int32_t(std::floor(v0.x)), y0 = int32_t(std::floor(v0.y));
+			const int32_t x1 = int32_t(std::floor(v1.x)), y1 = int32_t(std::floor(v1.y));
+			const int32_t dx = std::abs(x1 - x0), dy = -std::abs(y1 - y0);
+			const int32_t sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+			const olc::Pixel p(uint8_t(v0.r * 255.0f), uint8_t(v0.g * 255.0f), uint8_t(v0.b * 255.0f), uint8_t(v0.a * 255.0f));
+			int32_t err = dx + dy;
+			while (true)
+			{
+				if (x0 >= vViewPos.x && x0 < vViewPos.x + vViewSize.x && y0 >= vViewPos.y && y0 < vViewPos.y + vViewSize.y)
+					Blend(p, sprFrame.pColData[y0 * sprFrame.width + x0]);
+				if (x0 == x1 && y0 == y1) break;
+				const int32_t e2 = 2 * err;
+				if (e2 >= dy) { err += dy; x0 += sx; }
+				if (e2 <= dx) { err += dx; y0 += sy; }
+			}
 		}
 	};
 }
 #endif
 // O------------------------------------------------------------------------------O
-// | END RENDERER: OpenGL 3.3 (3.0 es) (sh-sh-sh-shaders....)                     |
+// | END RENDERER: Null                                                           |
 // O------------------------------------------------------------------------------O
 #pragma endregion
 
@@ -4482,6 +6512,28 @@ namespace olc
 
 		olc::rcode SaveImageResource(olc::Sprite* spr, const std::string& sImageFile) override
 		{
+			FILE* f = fopen(sImageFile.c_str(), "wb");
+			if (!f) return olc::rcode::NO_FILE;
+
+			png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+			png_infop info = png ? png_create_info_struct(png) : nullptr;
+			if (!png || !info || setjmp(png_jmpbuf(png)))
+			{
+				png_destroy_write_struct(&png, &info);
+				fclose(f);
+				return olc::rcode::FAIL;
+			}
+
+			// olc::Pixel is laid out as RGBA bytes, so rows can be written directly
+			png_init_io(png, f);
+			png_set_IHDR(png, info, spr->width, spr->height, 8, PNG_COLOR_TYPE_RGBA,
+				PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+			png_write_info(png, info);
+			for (int y = 0; y < spr->height; y++)
+				png_write_row(png, (png_const_bytep)(spr->GetData() + y * spr->width));
+			png_write_end(png, nullptr);
+			png_destroy_write_struct(&png, &info);
+			fclose(f);
 			return olc::rcode::OK;
 		}
 	};
@@ -5768,6 +7820,182 @@ extern "C"
 // O------------------------------------------------------------------------------O
 #pragma endregion
 
+#pragma region platform_headless
+// O------------------------------------------------------------------------------O
+// | START PLATFORM: HEADLESS - no window, input comes from a script              |
+// O------------------------------------------------------------------------------O
+#if defined(OLC_PLATFORM_HEADLESS)
+namespace olc
+{
+	olc::rcode HeadlessConfig::LoadScript(const std::string& sFile)
+	{
+		std::ifstream ifs(sFile);
+		if (!ifs.is_open()) return olc::rcode::NO_FILE;
+
+		// Names in olc::Key order, so the index is the key code
+		static const char* sKeyNames[] = {
+			"NONE",
+			"A", "B", "C", "D", "E", "F", "G", "H", "I", "J", "K", "L", "M", "N", "O", "P", "Q", "R", "S", "T", "U", "V", "W", "X", "Y", "Z",
+			"K0", "K1", "K2", "K3", "K4", "K5", "K6", "K7", "K8", "K9",
+			"F1", "F2", "F3", "F4", "F5", "F6", "F7", "F8", "F9", "F10", "F11", "F12",
+			"UP", "DOWN", "LEFT", "RIGHT",
+			"SPACE", "TAB", "SHIFT", "CTRL", "INS", "DEL", "HOME", "END", "PGUP", "PGDN",
+			"BACK", "ESCAPE", "RETURN", "ENTER", "PAUSE", "SCROLL",
+			"NP0", "NP1", "NP2", "NP3", "NP4", "NP5", "NP6", "NP7", "NP8", "NP9",
+			"NP_MUL", "NP_DIV", "NP_ADD", "NP_SUB", "NP_DECIMAL", "PERIOD",
+			"EQUALS", "COMMA", "MINUS",
+			"OEM_1", "OEM_2", "OEM_3", "OEM_4", "OEM_5", "OEM_6", "OEM_7", "OEM_8",
+			"CAPS_LOCK" };
+		static_assert(sizeof(sKeyNames) / sizeof(sKeyNames[0]) == size_t(olc::Key::ENUM_END), "Key names out of step with olc::Key");
+
+		std::vector<HeadlessEvent> vEvents;
+		std::string sLine;
+		while (std::getline(ifs, sLine))
+		{
+			std::istringstream line(sLine);
+			std::string sVerb;
+			HeadlessEvent e;
+			if (!(line >> e.nFrame >> sVerb)) continue; // blank or comment
+
+			auto ReadState = [&]() { std::string s; line >> s; return s == "down"; };
+
+			if (sVerb == "key")
+			{
+				std::string sName;
+				line >> sName;
+				auto it = std::find_if(std::begin(sKeyNames), std::end(sKeyNames), [&](const char* k) { return sName == k; });
+				if (it == std::end(sKeyNames)) return olc::rcode::FAIL;
+				e.type = HeadlessEvent::Type::KEY;
+				e.nCode = int32_t(it - std::begin(sKeyNames));
+				e.bState = ReadState();
+			}
+			else if (sVerb == "mouse")
+			{
+				e.type = HeadlessEvent::Type::MOUSE_MOVE;
+				line >> e.vPos.x >> e.vPos.y;
+			}
+			else if (sVerb == "button")
+			{
+				e.type = HeadlessEvent::Type::MOUSE_BUTTON;
+				line >> e.nCode;
+				if (e.nCode < 0 || e.nCode >= nMouseButtons) return olc::rcode::FAIL;
+				e.bState = ReadState();
+			}
+			else if (sVerb == "wheel")
+			{
+				e.type = HeadlessEvent::Type::MOUSE_WHEEL;
+				line >> e.nCode;
+			}
+			else if (sVerb == "quit")
+				e.type = HeadlessEvent::Type::QUIT;
+			else
+				return olc::rcode::FAIL;
+
+			if (line.fail()) return olc::rcode::FAIL;
+			vEvents.push_back(e);
+		}
+
+		vScript.insert(vScript.end(), vEvents.begin(), vEvents.end());
+		std::stable_sort(vScript.begin(), vScript.end(), [](const HeadlessEvent& a, const HeadlessEvent& b) { return a.nFrame < b.nFrame; });
+		return olc::rcode::OK;
+	}
+
+	class Platform_Headless : public olc::Platform
+	{
+	private:
+		uint32_t nFrame = 0;
+		size_t nNextEvent = 0;
+
+	public:
+		virtual olc::rcode ApplicationStartUp() override
+		{
+			nFrame = 0;
+			nNextEvent = 0;
+			return olc::rcode::OK;
+		}
+
+		virtual olc::rcode ApplicationCleanUp() override
+		{
+			return olc::rcode::OK;
+		}
+
+		virtual olc::rcode ThreadStartUp() override
+		{
+			return olc::rcode::OK;
+		}
+
+		virtual olc::rcode ThreadCleanUp() override
+		{
+			renderer->DestroyDevice();
+			return olc::OK;
+		}
+
+		virtual olc::rcode CreateGraphics(bool bFullScreen, bool bEnableVSYNC, const olc::vi2d& vViewPos, const olc::vi2d& vViewSize) override
+		{
+			if (renderer->CreateDevice({}, bFullScreen, bEnableVSYNC) == olc::rcode::OK)
+			{
+				renderer->UpdateViewport(vViewPos, vViewSize);
+				return olc::rcode::OK;
+			}
+			else
+				return olc::rcode::FAIL;
+		}
+
+		virtual olc::rcode CreateWindowPane(const olc::vi2d& vWindowPos, olc::vi2d& vWindowSize, bool bFullScreen) override
+		{
+			UNUSED(vWindowPos);
+			UNUSED(vWindowSize);
+			UNUSED(bFullScreen);
+			// The "window" always has focus, there is nobody else to give it to
+			ptrPGE->olc_UpdateKeyFocus(true);
+			ptrPGE->olc_UpdateMouseFocus(true);
+			return olc::OK;
+		}
+
+		virtual olc::rcode SetWindowTitle(const std::string& s) override
+		{
+			UNUSED(s);
+			return olc::OK;
+		}
+
+		virtual olc::rcode StartSystemEventLoop() override
+		{
+			return olc::OK;
+		}
+
+		virtual olc::rcode HandleSystemEvent() override
+		{
+			const olc::HeadlessConfig& config = ptrPGE->GetHeadlessConfig();
+
+			// Deliver this frame's scripted input, as if it had arrived from the OS
+			while (nNextEvent < config.vScript.size() && config.vScript[nNextEvent].nFrame <= nFrame)
+			{
+				const olc::HeadlessEvent& e = config.vScript[nNextEvent++];
+				switch (e.type)
+				{
+				case olc::HeadlessEvent::Type::KEY:          ptrPGE->olc_UpdateKeyState(e.nCode, e.bState); break;
+				case olc::HeadlessEvent::Type::MOUSE_MOVE:   ptrPGE->olc_UpdateMouse(e.vPos.x, e.vPos.y); break;
+				case olc::HeadlessEvent::Type::MOUSE_BUTTON: ptrPGE->olc_UpdateMouseState(e.nCode, e.bState); break;
+				case olc::HeadlessEvent::Type::MOUSE_WHEEL:  ptrPGE->olc_UpdateMouseWheel(e.nCode); break;
+				case olc::HeadlessEvent::Type::QUIT:         ptrPGE->olc_Terminate(); break;
+				}
+			}
+
+			// The frame being started is the last one we were asked for
+			if (config.nMaxFrames > 0 && nFrame + 1 >= config.nMaxFrames)
+				ptrPGE->olc_Terminate();
+
+			nFrame++;
+			return olc::OK;
+		}
+	};
+}
+#endif
+// O------------------------------------------------------------------------------O
+// | END PLATFORM: HEADLESS                                                       |
+// O------------------------------------------------------------------------------O
+#pragma endregion
+
 
 #endif // Headless
 
@@ -5817,6 +8045,10 @@ namespace olc
 		platform = std::make_unique<olc::Platform_Emscripten>();
 #endif
 
+#if defined(OLC_PLATFORM_HEADLESS)
+		platform = std::make_unique<olc::Platform_Headless>();
+#endif
+
 #if defined(OLC_PLATFORM_CUSTOM_EX)
 		platform = std::make_unique<OLC_PLATFORM_CUSTOM_EX>();
 #endif
@@ -5831,6 +8063,10 @@ namespace olc
 		renderer = std::make_unique<olc::Renderer_OGL33>();
 #endif
 
+#if defined(OLC_GFX_NULL)
+		renderer = std::make_unique<olc::Renderer_Null>();
+#endif
+
 #if defined(OLC_GFX_OPENGLES2)
 		renderer = std::make_unique<olc::Renderer_OGLES2>();
 #endif
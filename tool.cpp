@@ -0,0 +1,288 @@
+#define OLC_PGE_APPLICATION
+
+#include "olcPixelGameEngine.h"
+#include "StarSystem.h"
+#include "Corpus.h"
+#include "ArrowExport.h"
+#include "TextExport.h"
+#include "TileStore.h"
+
+#include <chrono>
+#include <iostream>
+
+#if !defined(CORPUS_GOLDEN_PATH)
+#define CORPUS_GOLDEN_PATH "corpus/golden.txt"
+#endif
+
+/**
+ * Checks the generator against the checked-in corpus digest, or rewrites it after an intended change
+ */
+static int runCorpus(int argc, char *argv[]) {
+    const std::string mode = argc > 2 ? argv[2] : "";
+    if (mode != "verify" && mode != "record") {
+        std::cerr << "Usage: " << argv[0] << " corpus verify|record [--golden file] [--threads n]"
+                  << " [--size n] [--origin x y]\n";
+        return 2;
+    }
+
+    std::string goldenPath = CORPUS_GOLDEN_PATH;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    CorpusRegion region;
+    bool regionGiven = false;
+
+    for (int i = 3; i < argc; i++) {
+        const std::string arg = argv[i];
+        const int valuesLeft = argc - i - 1;
+
+        if (arg == "--golden" && valuesLeft >= 1) goldenPath = argv[++i];
+        else if (arg == "--threads" && valuesLeft >= 1) threads = std::stoul(argv[++i]);
+        else if (arg == "--size" && valuesLeft >= 1) {
+            region.size = std::stoul(argv[++i]);
+            regionGiven = true;
+        } else if (arg == "--origin" && valuesLeft >= 2) {
+            region.originX = std::stoul(argv[++i]);
+            region.originY = std::stoul(argv[++i]);
+            regionGiven = true;
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return 2;
+        }
+    }
+
+    CorpusDigest golden;
+    if (mode == "verify") {
+        if (!loadCorpusDigest(golden, goldenPath)) {
+            std::cerr << "Could not read corpus digest " << goldenPath << "\n";
+            return 2;
+        }
+        if (regionGiven && !(region == golden.region)) {
+            std::cerr << "The region is fixed by " << goldenPath << " when verifying\n";
+            return 2;
+        }
+        region = golden.region;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const CorpusDigest digest = generateCorpus(region, threads);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Generated " << region.size << "x" << region.size << " sectors from (" << region.originX << ", "
+              << region.originY << ") in " << seconds << " s\n";
+
+    if (mode == "record") {
+        if (!saveCorpusDigest(digest, goldenPath)) {
+            std::cerr << "Could not write corpus digest " << goldenPath << "\n";
+            return 2;
+        }
+        std::cout << "Recorded " << goldenPath << "\n";
+        return 0;
+    }
+
+    if (compareCorpus(golden, digest, std::cout) == 0) {
+        std::cout << "Corpus matches " << goldenPath << "\n";
+        return 0;
+    }
+    std::cout << "Corpus does NOT match " << goldenPath << "\n";
+    return 1;
+}
+
+/**
+ * Generates a region and writes its systems and planets out for analysis elsewhere
+ */
+static int runExport(int argc, char *argv[]) {
+    const std::string format = argc > 2 ? argv[2] : "";
+    if (format != "arrow" && format != "csv" && format != "ndjson") {
+        std::cerr << "Usage: " << argv[0] << " export arrow|csv|ndjson --out prefix|file|- [--size w h]"
+                  << " [--origin x y] [--band rows] [--threads n]\n";
+        return 2;
+    }
+
+    std::string outPath;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    ExportRegion region;
+
+    for (int i = 3; i < argc; i++) {
+        const std::string arg = argv[i];
+        const int valuesLeft = argc - i - 1;
+
+        if (arg == "--out" && valuesLeft >= 1) outPath = argv[++i];
+        else if (arg == "--threads" && valuesLeft >= 1) threads = std::stoul(argv[++i]);
+        else if (arg == "--band" && valuesLeft >= 1) region.bandRows = std::max(1ul, std::stoul(argv[++i]));
+        else if (arg == "--size" && valuesLeft >= 2) {
+            region.width = std::stoul(argv[++i]);
+            region.height = std::stoul(argv[++i]);
+        } else if (arg == "--origin" && valuesLeft >= 2) {
+            region.originX = std::stoul(argv[++i]);
+            region.originY = std::stoul(argv[++i]);
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return 2;
+        }
+    }
+    if (outPath.empty()) {
+        std::cerr << "export needs --out\n";
+        return 2;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    if (format != "arrow") {
+        // Text goes to a file or, given -, to stdout, with progress kept to stderr out of its way
+        std::FILE *out = outPath == "-" ? stdout : std::fopen(outPath.c_str(), "wb");
+        if (!out) {
+            std::cerr << "Could not open " << outPath << "\n";
+            return 1;
+        }
+        std::setvbuf(out, nullptr, _IOFBF, 1 << 20);
+        const int64_t bytes = exportText(region, threads, format == "csv" ? TextFormat::CSV : TextFormat::NDJSON,
+                                         out);
+        if (out != stdout && std::fclose(out) != 0) return 1;
+        if (bytes < 0) {
+            std::cerr << "Could not write " << outPath << "\n";
+            return 1;
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << "Exported " << region.width << "x" << region.height << " sectors, " << bytes << " bytes in "
+                  << seconds << " s (" << double(bytes) / seconds / 1e6 << " MB/s)\n";
+        return 0;
+    }
+
+    const std::string systemsPath = outPath + "_systems.arrow", planetsPath = outPath + "_planets.arrow";
+    if (!exportArrow(region, threads, systemsPath, planetsPath)) {
+        std::cerr << "Could not write " << systemsPath << " and " << planetsPath << "\n";
+        return 1;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Exported " << region.width << "x" << region.height << " sectors from (" << region.originX << ", "
+              << region.originY << ") to " << systemsPath << " and " << planetsPath << " in " << seconds << " s\n";
+    return 0;
+}
+
+/**
+ * Builds a tile store for the galaxy view, or checks one against the generator
+ */
+static int runTiles(int argc, char *argv[]) {
+    const std::string mode = argc > 2 ? argv[2] : "";
+    if (mode != "build" && mode != "check") {
+        std::cerr << "Usage: " << argv[0] << " tiles build --out file [--tiles w h] [--origin tx ty] [--shaped]"
+                  << " [--threads n]\n"
+                  << "       " << argv[0] << " tiles check file\n";
+        return 2;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    if (mode == "check") {
+        if (argc < 4) {
+            std::cerr << "tiles check needs a file\n";
+            return 2;
+        }
+        tiles::TileStore store;
+        if (!store.open(argv[3])) {
+            std::cerr << "Could not read tile store " << argv[3] << "\n";
+            return 1;
+        }
+
+        // Every stored system is packed again next to a freshly generated one, so any field that differs
+        // by a bit is caught
+        const tiles::Header &header = store.getHeader();
+        const std::unique_ptr<GalaxyShape> shape(header.shaped ? new GalaxyShape() : nullptr);
+        tiles::DecodedTile tile;
+        std::vector<uint8_t> stored, generated;
+        uint64_t stars = 0, mismatches = 0;
+        for (uint64_t t = 0; t < header.tiles(); t++) {
+            if (!store.readTile(t, tile, true)) {
+                std::cerr << "Could not read tile " << t << "\n";
+                return 1;
+            }
+            for (uint32_t j = 0; j < tiles::TILE_SIZE; j++)
+                for (uint32_t i = 0; i < tiles::TILE_SIZE; i++) {
+                    const uint32_t x = tile.tileX * tiles::TILE_SIZE + i, y = tile.tileY * tiles::TILE_SIZE + j;
+                    const StarSystem star(x, y, true, shape ? shape->probability(x, y) : -1.0f);
+                    if (star.starExists != tile.starExists(i, j)) {
+                        mismatches++;
+                        continue;
+                    }
+                    if (!star.starExists) continue;
+                    stars++;
+                    const auto system = tile.system(i, j);
+                    stored.clear();
+                    generated.clear();
+                    tiles::packSystem(stored, *system);
+                    tiles::packSystem(generated, star);
+                    const bool seedsMatch = std::equal(
+                            star.planets.begin(), star.planets.end(), system->planets.begin(),
+                            [](const Planet &a, const Planet &b) { return a.seed == b.seed; });
+                    if (stored != generated || !seedsMatch) mismatches++;
+                }
+            // Existence and systems read straight from the file agree with the whole tile, down a diagonal
+            for (uint32_t k = 0; k < tiles::TILE_SIZE; k++) {
+                const uint32_t i = k, j = (k * 37 + uint32_t(t)) % tiles::TILE_SIZE;
+                const uint32_t x = tile.tileX * tiles::TILE_SIZE + i, y = tile.tileY * tiles::TILE_SIZE + j;
+                if (store.starExists(x, y) != tile.starExists(i, j)) mismatches++;
+                const auto system = store.readSystem(x, y);
+                if ((system != nullptr) != tile.starExists(i, j)) mismatches++;
+                if (!system) continue;
+                stored.clear();
+                generated.clear();
+                tiles::packSystem(stored, *system);
+                tiles::packSystem(generated, *tile.system(i, j));
+                if (stored != generated) mismatches++;
+            }
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Checked " << header.tiles() << " tiles, " << stars << " stars, " << mismatches
+                  << " mismatches in " << seconds << " s\n";
+        return mismatches == 0 ? 0 : 1;
+    }
+
+    std::string outPath;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    tiles::Header header;
+    header.tilesW = header.tilesH = 4;
+
+    for (int i = 3; i < argc; i++) {
+        const std::string arg = argv[i];
+        const int valuesLeft = argc - i - 1;
+
+        if (arg == "--out" && valuesLeft >= 1) outPath = argv[++i];
+        else if (arg == "--threads" && valuesLeft >= 1) threads = std::stoul(argv[++i]);
+        else if (arg == "--shaped") header.shaped = true;
+        else if (arg == "--tiles" && valuesLeft >= 2) {
+            header.tilesW = std::stoul(argv[++i]);
+            header.tilesH = std::stoul(argv[++i]);
+        } else if (arg == "--origin" && valuesLeft >= 2) {
+            header.tileX = std::stoul(argv[++i]);
+            header.tileY = std::stoul(argv[++i]);
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return 2;
+        }
+    }
+    if (outPath.empty()) {
+        std::cerr << "tiles build needs --out\n";
+        return 2;
+    }
+
+    if (!tiles::buildTileStore(outPath, header, threads)) {
+        std::cerr << "Could not write " << outPath << "\n";
+        return 1;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Built " << header.tilesW << "x" << header.tilesH << " tiles from (" << header.tileX << ", "
+              << header.tileY << "), sectors (" << header.tileX * tiles::TILE_SIZE << ", "
+              << header.tileY * tiles::TILE_SIZE << ") on, into " << outPath << " in " << seconds << " s\n";
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const std::string command = argc > 1 ? argv[1] : "";
+
+    if (command == "corpus") return runCorpus(argc, argv);
+    if (command == "export") return runExport(argc, argv);
+    if (command == "tiles") return runTiles(argc, argv);
+
+    std::cerr << "Usage: " << argv[0] << " <command> ...\n"
+              << "  corpus verify|record   check the generator against its checked-in digest\n"
+              << "  export arrow           write a region's systems and planets as Arrow IPC files\n"
+              << "  export csv|ndjson      stream a region's systems as text to a file or stdout\n"
+              << "  tiles build|check      write sectors to a compressed tile store for the galaxy view\n";
+    return 2;
+}